@@ -0,0 +1,210 @@
+/*!
+ * \file	bearing.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * The ADC interrupt records the microphones in blocks of MIC_BLOCK_NB scans
+ * (8.4 kHz, the rate of the ADC scan that also serves the proximity sensors
+ * and the accelerometer). Each block is reduced to one DFT bin per
+ * microphone, the bin of BEACON_FREQ.
+ *
+ * A plane wave from the direction u reaches the microphone at p with the
+ * phase phi0 + w * (p . u) / c. The two phase differences to microphone 0
+ * give a linear system in u, solved with the adjugate of the microphone
+ * geometry; the scale does not matter for the direction. This needs the
+ * microphones closer than half a wave length (8 cm at 2.1 kHz).
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <stdlib.h>
+
+#include <a_d/advance_ad_scan/e_ad_conv.h>
+
+#include "configuration.h"
+#include "odometry.h"
+#include "bearing.h"
+
+#if DBG_INCLUDE_BEARING == 1
+
+/*!
+ * The DFT bin of the beacon.
+ */
+#define BIN	((int)(BEACON_FREQ * MIC_BLOCK_NB * 1e-9 * AD_SCAN_PERIOD_NS \
+			+ 0.5))
+
+/*!
+ * The phase step of the bin per scan, as a binary angle.
+ */
+#define BIN_STEP	((unsigned int)(BIN * (65536L / MIC_BLOCK_NB)))
+
+/*!
+ * The terms of the DFT are divided by 2^DFT_SHIFT, so that the sums of
+ * 64 samples fit.
+ */
+#define DFT_SHIFT	6
+
+/*!
+ * The adjugate of the geometry, rows p1 - p0 and p2 - p0, with the sign of
+ * its determinant.
+ */
+#define GEO_A	(MIC1_X - MIC0_X)
+#define GEO_B	(MIC1_Y - MIC0_Y)
+#define GEO_C	(MIC2_X - MIC0_X)
+#define GEO_D	(MIC2_Y - MIC0_Y)
+#define GEO_SIGN	(((GEO_A * GEO_D - GEO_B * GEO_C) < 0) ? -1 : 1)
+
+static int blocks[2 * 3 * MIC_BLOCK_NB];
+static unsigned int last_block = 0;	/*!< The last block processed */
+static unsigned int angle = 0;		/*!< The last bearing */
+static int valid = 0;			/*!< The beacon was heard */
+
+/* atan(z) for z in [0, 1] (Q15), as a binary angle in [0, 0x2000] */
+static unsigned int atan_q15(unsigned int z)
+{
+	/* atan(z) ~ pi/4 z + 0.273 z (1 - z), within 0.22 degree */
+	return (z >> 2) + (__builtin_muluu(
+			__builtin_muluu(z, 32768U - z) >> 15, 2847) >> 15);
+}
+
+/*!
+ * Gives the angle of a vector.
+ *
+ * \param	y	The y coordinate.
+ * \param	x	The x coordinate.
+ *
+ * \return	The angle as a binary angle, 65536 is a full turn, 0 if the
+ * 		vector is null.
+ */
+unsigned int bearing_atan2(long y, long x)
+{
+	unsigned long ax = labs(x), ay = labs(y);
+	unsigned int a;
+
+	while ((ax | ay) >= 0x8000) {
+		ax >>= 1;
+		ay >>= 1;
+	}
+	if ((ax | ay) == 0)
+		return 0;
+
+	if (ay <= ax)
+		a = atan_q15(__builtin_divud(ay << 15, ax));
+	else
+		a = 0x4000 - atan_q15(__builtin_divud(ax << 15, ay));
+	if (x < 0)
+		a = 0x8000 - a;
+	if (y < 0)
+		a = -a;
+	return a;
+}
+
+/*
+ * The bin of one microphone, x has a stride of 3 ints in the block.
+ */
+static void dft(const int *x, long *re, long *im)
+{
+	long mean = 0;
+	unsigned int phase = 0;
+	int i, v;
+
+	for (i = 0; i < MIC_BLOCK_NB; i++)
+		mean += x[3 * i];
+	mean /= MIC_BLOCK_NB;
+
+	*re = 0;
+	*im = 0;
+	for (i = 0; i < MIC_BLOCK_NB; i++) {
+		v = x[3 * i] - mean;
+		*re += __builtin_mulss(v, odo_cos(phase)) >> DFT_SHIFT;
+		*im -= __builtin_mulss(v, odo_sin(phase)) >> DFT_SHIFT;
+		phase += BIN_STEP;
+	}
+}
+
+/*!
+ * Starts the capture of the microphones.
+ */
+void bearing_init(void)
+{
+	e_init_ad_scan();
+	e_ad_set_mic_blocks(blocks, MIC_BLOCK_NB);
+}
+
+/*!
+ * Estimates the bearing from the last block of the microphones, if there
+ * is a new one.
+ *
+ * \return	Whether a new estimate was made.
+ */
+int bearing_update(void)
+{
+	const int *block;
+	unsigned int count, phase[3];
+	long re, im, level = 0;
+	int i, d1, d2;
+
+	block = e_ad_get_mic_block(&count);
+	if ((block == NULL) || (count == last_block))
+		return 0;
+	last_block = count;
+
+	/*
+	 * The ADC interrupt refills the block as soon as the next one is
+	 * complete, only a block whose count did not move is used.
+	 */
+	if (e_mic_block_count != count)
+		return 0;
+	for (i = 0; i < 3; i++) {
+		dft(block + i, &re, &im);
+		/* microphone i is converted i/8 of a scan after microphone 0 */
+		phase[i] = bearing_atan2(im, re) - i * (BIN_STEP / 8);
+		if (i == 0)
+			level = labs(re) + labs(im);
+	}
+	if (e_mic_block_count != count) {
+		/* the block was refilled meanwhile */
+		return 0;
+	}
+
+	/* a tone of amplitude A gives a bin of A * N/2 * 2^15 / 2^DFT_SHIFT */
+	valid = (level >= (long)BEACON_LEVEL * MIC_BLOCK_NB
+			* (32768L >> (DFT_SHIFT + 1)));
+	if (valid) {
+		d1 = phase[1] - phase[0];
+		d2 = phase[2] - phase[0];
+		angle = bearing_atan2(
+				GEO_SIGN * ((long)GEO_A * d2 - (long)GEO_C * d1),
+				GEO_SIGN * ((long)GEO_D * d1 - (long)GEO_B * d2));
+	}
+	return 1;
+}
+
+/*!
+ * Gives the last bearing to the beacon.
+ *
+ * \param	a	Where to store the bearing, a binary angle from the
+ * 			front of the robot, counterclockwise.
+ *
+ * \return	Whether the beacon was heard in the last block.
+ */
+int bearing_get(unsigned int *a)
+{
+	*a = angle;
+	return valid;
+}
+
+#endif	/* DBG_INCLUDE_BEARING */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,34 @@
+/*!
+ * \file	bearing.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Bearing to a beacon tone, from the phase of the tone at the three
+ * microphones.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef BEARING_H_
+#define BEARING_H_
+
+void bearing_init(void);
+int bearing_update(void);
+int bearing_get(unsigned int *angle);
+
+unsigned int bearing_atan2(long y, long x);
+
+#endif /* BEARING_H_ */
+
+/*!
+ * @}
+ */
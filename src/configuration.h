@@ -26,6 +26,25 @@
  * 		arbitrary modules.
  */
 #define DBG_INCLUDE_PROXIMITY		1
+#if DBG_INCLUDE_PROXIMITY == 1
+/*!
+ * Whether the proximity sensors are calibrated at each start. Otherwise the
+ * calibration saved in the EEPROM is used, and measured only if there is
+ * none.
+ */
+#define PROX_CALIBRATE			0
+/*
+ * Proximity schedule, in ADC scans of 119.4 us (see e_ad_conv.h).
+ */
+#define PROX_PULSE_SCANS	3	/*!< IR LEDs on, per pair */
+#define PROX_GAP_SCANS		9	/*!< IR LEDs off before each pulse */
+#define PROX_WAIT_SCANS		800	/*!< Wait per cycle while stopped */
+/*!
+ * Brightness of the LED facing the closest object, from 1 to 8 (always
+ * on). Below 8 it is pulsed at 125 Hz by the scheduler tick.
+ */
+#define PROX_LED_LEVEL		8
+#endif	/* DBG_INCLUDE_PROXIMITY */
 
 
 /*!
@@ -38,28 +57,222 @@
 #define DBG_INCLUDE_MOTION		1
 #if DBG_INCLUDE_MOTION == 1
 /*
- * Motion configuration parameters.
+ * Motion configuration parameters. They are the values of PP_MOVING_SPEED
+ * and PP_MOTION_ACCEL until a PMT_PARAM changes them, see params.c.
  */
-#define MOVING_SPEED 200	/*!< The speed at which the puck moves */
-#define TURNING_SPEED 50	/*!< The speed at which the puck turns */
+#define MOVING_SPEED 200	/*!< The speed without obstacle, see navigation.c */
+#define MOTION_ACCEL 2000	/*!< The acceleration of the wheels, steps/s^2 */
 #endif	/* DBG_INCLUDE_MOTION */
 
 
+/*!
+ * Whether the pose is estimated from the motor steps and sent as PMT_POSE.
+ * It needs the motion module.
+ */
+#define DBG_INCLUDE_ODOMETRY		1
+#if DBG_INCLUDE_ODOMETRY == 1
+/*
+ * Odometry configuration parameters.
+ */
+#define ODO_PERIOD	20	/*!< Period of the pose updates in ms */
+#define POSE_PERIOD	200	/*!< Period of the PMT_POSE messages in ms */
+#define ODO_ACC_PER_G	800	/*!< Accelerometer counts per g */
+/*!
+ * Speed difference between the wheels and the accelerometer above which
+ * the wheels slip, in mm/s.
+ */
+#define ODO_SLIP_LEVEL	40
+#endif	/* DBG_INCLUDE_ODOMETRY */
+
+
+/*!
+ * Whether the bearing to a beacon tone is estimated from the microphones.
+ */
+#define DBG_INCLUDE_BEARING		1
+#if DBG_INCLUDE_BEARING == 1
+/*
+ * Bearing configuration parameters.
+ */
+#define BEACON_FREQ	2100	/*!< Frequency of the beacon tone in Hz */
+#define BEACON_LEVEL	40	/*!< Lowest tone amplitude, in ADC counts */
+#define BEARING_PERIOD	50	/*!< Period of the estimates in ms */
+#define MIC_BLOCK_NB	32	/*!< Scans per block, at most 64 */
+/*
+ * Positions of the microphones in mm, x to the front and y to the left of
+ * the robot. Measure them on the robot, the bearing depends on them.
+ */
+#define MIC0_X		10	/*!< Right microphone */
+#define MIC0_Y		(-25)
+#define MIC1_X		10	/*!< Left microphone */
+#define MIC1_Y		25
+#define MIC2_X		(-30)	/*!< Back microphone */
+#define MIC2_Y		0
+#endif	/* DBG_INCLUDE_BEARING */
+
+
+/*!
+ * Whether the interrupts and the main loop are measured with Timer 2, and
+ * the counters sent as PMT_STATS. See profile/e_profile.h.
+ */
+#define DBG_INCLUDE_PROFILE		0
+#if DBG_INCLUDE_PROFILE == 1
+#define STATS_PERIOD	1000	/*!< Period of the PMT_STATS messages in ms */
+#endif	/* DBG_INCLUDE_PROFILE */
+
+/*!
+ * Whether the program is built to benchmark the link with
+ * tools/pucom_bench.c: the selector is ignored and only the sensing runs,
+ * as in position SEL_SENSING. The image geometry is the one below, a sweep
+ * needs one build per geometry.
+ */
+#define DBG_BENCHMARK			0
+
+/*!
+ * Whether the core sleeps while the selector is in position 0, once the
+ * wheels stand still and the camera is in standby. See power.c.
+ */
+#define DBG_INCLUDE_POWER		1
+#if DBG_INCLUDE_POWER == 1
+/*!
+ * Time the robot stays awake in position 0 after it woke up or received a
+ * byte, in ms, so that it answers the server.
+ */
+#define POWER_AWAKE_TIME	2000
+#endif	/* DBG_INCLUDE_POWER */
+
+/*
+ * Interrupt priorities, from 1 (lowest) to 7, applied by irq_init() over
+ * the ones set by the drivers. An interrupt nests into the ones of lower
+ * priority. The camera line reads the pixels at fixed cycles from its
+ * entry, a late entry tears the row: it is alone at 7, where neither DISI
+ * nor the critical sections hold it back. Nothing can hold it off either, so
+ * an interrupt at 7 must leave the state of the code it interrupts as it
+ * found it: it saves RCOUNT if it uses REPEAT, it uses no DO loop (the DO
+ * shadows) and it is the only one to use push.s (one level of shadows).
+ */
+#define IRQ_PRIO_CAM_LINE	7	/*!< Timer4, HSYNC, reads a row */
+#define IRQ_PRIO_CAM_FRAME	6	/*!< Timer5, VSYNC, starts Timer4 */
+#define IRQ_PRIO_UART		5	/*!< UART1 and UART2, 4 bytes of FIFO */
+#define IRQ_PRIO_I2C		5	/*!< I2C master */
+#define IRQ_PRIO_MOTORS		4	/*!< Timer3, a step is late by the delay */
+#define IRQ_PRIO_PROFILE	4	/*!< Timer2, see profile/e_profile.h */
+#define IRQ_PRIO_ADC		3	/*!< ADC scan, every 119 us */
+#define IRQ_PRIO_TICK		1	/*!< Timer1, the scheduler tick */
+#define IRQ_PRIO_WAKE		1	/*!< Change notification, see power.c */
+/*!
+ * The level of the critical sections of the main loop: above every
+ * interrupt that shares data with it, below the camera line.
+ */
+#define IRQ_PRIO_MASK		6
+
+
 #define DBG_INCLUDE_TRANSMISSION	1
+#if DBG_INCLUDE_TRANSMISSION == 1
+/*
+ * Transmission configuration parameters.
+ */
+/*!
+ * Whether the images are sent as differences to the previous one
+ * (PMT_VISUAL_DELTA) when this is shorter.
+ */
+#define IMG_DELTA		1
+/*!
+ * Maximum number of PMT_VISUAL_DELTA between two raw images.
+ */
+#define IMG_KEY_INTERVAL	16
+/*!
+ * Size of the coding buffer. A longer code is not sent, the image is sent raw
+ * instead.
+ */
+#define IMG_DELTA_MAX		((IMG_H * IMG_W) / 2)
+/*!
+ * Whether the rows are sent while the image is captured
+ * (PMT_VISUAL_ROWS). This needs the camera and replaces the delta coding.
+ */
+#define IMG_STREAM		0
+/*!
+ * Whether a result of the image processing is sent instead of the images:
+ *	- IMG_RESULT_NONE: the images are sent,
+ *	- IMG_RESULT_PROFILE: the column sums (PMT_VISUAL_PROFILE),
+ *	- IMG_RESULT_BLOB: the centroid of the pixels at or above
+ *	  IMG_BLOB_THRESHOLD (PMT_VISUAL_BLOB).
+ */
+#define IMG_RESULT		IMG_RESULT_NONE
+#define IMG_RESULT_NONE		0
+#define IMG_RESULT_PROFILE	1
+#define IMG_RESULT_BLOB		2
+#define IMG_BLOB_THRESHOLD	200	/*!< Gray level of the blob pixels */
+/*!
+ * Number of images sent without waiting for their acknowledgment
+ * (PMT_VISUAL_SEQ), 0 for the stop-and-wait of pucom. An image keeps its
+ * buffer until it is acknowledged, so there must be more buffers. It does
+ * not work with IMG_STREAM.
+ */
+#define TX_WINDOW		0
+/*!
+ * Time without acknowledgment after which the messages are sent again, from
+ * the configuration or from the oldest image of the window, in ms.
+ */
+#define TX_ACK_TIMEOUT		500
+/*!
+ * Whether the short messages (PMT_POSE, PMT_STATS) and the messages of the
+ * server (PMT_NAV_WEIGHTS) go over UART2, each with its PMT_ACK. The images
+ * then have UART1 to themselves. UART2 is on the extension connector, it
+ * needs a second link to the server.
+ */
+#define TX_UART2		0
+/*!
+ * Period of the PMT_SENSORS messages in ms, 0 for none. They need the
+ * proximity sensors, whose scan also samples the accelerometer.
+ */
+#define SENSORS_PERIOD		100
+/*!
+ * Whether an image is only sent while a wheel turns, when the scene changed
+ * or every IMG_KEEP_ALIVE ms, see img_policy.c. The other images go back to
+ * the camera. It does not work with IMG_STREAM. The host replay
+ * (tools/puck_sim.c) builds it with -DIMG_POLICY=1.
+ */
+#ifndef IMG_POLICY
+#define IMG_POLICY		0
+#endif
+#define IMG_CHANGE_LEVEL	4	/*!< Mean change of the blocks, gray levels */
+#define IMG_CHANGE_BIN		8	/*!< Size of the blocks, at most 16 */
+#define IMG_KEEP_ALIVE		1000	/*!< Longest time without an image, ms */
+/*!
+ * Whether the robot takes a time slot from the server (PMT_SLOT) and then
+ * only sends inside it, see slot.c. Its images are then marked with its
+ * number (PMT_VISUAL_ID). It does not work with IMG_STREAM.
+ */
+#define TX_SWARM		0
+#endif	/* DBG_INCLUDE_TRANSMISSION */
 
 
 #define DBG_INCLUDE_CAM			1
 #if DBG_INCLUDE_CAM == 1
 /*
- * Camera configuration parameters.
+ * Camera configuration parameters. The geometry is the largest one, the
+ * buffers are sized for it, and the one used until a PMT_PARAM changes it
+ * (PP_IMG_W, PP_IMG_H and PP_IMG_SS), see params.c.
  */
 #define IMG_H		25	/*!< Area of interest height */
 #define IMG_W		64	/*!< Area of interest width */
 #define IMG_SS		8	/*!< Sub-sampling ratio */
 /*!
- * Defines the color mode that should be use when configuring the camera.
+ * Number of image buffers. With three buffers, one image can be sent while
+ * the next one is ready and a third one is captured.
+ */
+#define IMG_BUF_COUNT	3
+/*!
+ * Defines the color mode that should be use when configuring the camera:
+ * GREY_SCALE_MODE, RGB_565_MODE or YUV_MODE. The colour modes take two
+ * bytes per pixel in the buffers, the area of interest must be smaller.
  */
 #define CAM_MODE 	GREY_SCALE_MODE
+/*!
+ * Whether the RGB565 images are packed to RGB332, one byte per pixel,
+ * before they are sent.
+ */
+#define IMG_PACK	1
 #endif	/* DBG_INCLUDE_CAM */
 
 #endif /* CONFIGURATION_H_ */
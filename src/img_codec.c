@@ -0,0 +1,168 @@
+/*!
+ * \file	img_codec.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include "img_codec.h"
+
+#define TAG_ZERO	0x00	/*!< Run of unchanged bytes */
+#define TAG_NIBBLE	0x40	/*!< Run of small differences */
+#define TAG_RAW		0x80	/*!< Run of differences */
+
+#define ZERO_MAX	64	/*!< Longest run of unchanged bytes */
+#define NIBBLE_MAX	64	/*!< Longest run of small differences */
+#define RAW_MAX		128	/*!< Longest run of differences */
+
+/*!
+ * A run of small differences is ended by this many unchanged bytes.
+ */
+#define ZERO_BREAK	4
+
+/*!
+ * Whether a difference fits in a nibble.
+ */
+#define IS_SMALL(d)	((int8_t)(d) >= -8 && (int8_t)(d) <= 7)
+
+/*!
+ * Counts the unchanged bytes from i on, at most max.
+ */
+static size_t zero_run(const uint8_t *img, const uint8_t *ref, size_t i,
+		size_t size, size_t max)
+{
+	size_t n = 0;
+
+	while ((i + n < size) && (n < max) && (img[i + n] == ref[i + n]))
+		n++;
+	return n;
+}
+
+/*!
+ * Codes an image as the difference to a reference image.
+ *
+ * \param	out	The buffer for the code.
+ * \param	max	The size of the buffer.
+ * \param	img	The image.
+ * \param	ref	The reference image, the last one sent.
+ * \param	size	The size of the images in bytes.
+ *
+ * \return	The length of the code, 0 if it would be longer than max. The
+ * 		image must be sent raw then.
+ */
+size_t img_delta_encode(uint8_t *out, size_t max, const uint8_t *img,
+		const uint8_t *ref, size_t size)
+{
+	size_t i = 0, o = 0, n, k;
+	uint8_t d;
+
+	while (i < size) {
+		d = img[i] - ref[i];
+
+		if (d == 0) {
+			n = zero_run(img, ref, i, size, ZERO_MAX);
+			if (o + 1 > max)
+				return 0;
+			out[o++] = TAG_ZERO | (n - 1);
+		}
+		else if (IS_SMALL(d)) {
+			n = 0;
+			while ((i + n < size) && (n < NIBBLE_MAX)
+					&& IS_SMALL(img[i + n] - ref[i + n])
+					&& (zero_run(img, ref, i + n, size,
+						ZERO_BREAK) < ZERO_BREAK))
+				n++;
+			if (o + 1 + (n + 1) / 2 > max)
+				return 0;
+			out[o++] = TAG_NIBBLE | (n - 1);
+			for (k = 0; k < n; k += 2) {
+				d = (img[i + k] - ref[i + k]) << 4;
+				if (k + 1 < n)
+					d |= (img[i + k + 1] - ref[i + k + 1])
+						& 0x0F;
+				out[o++] = d;
+			}
+		}
+		else {
+			/* a lone small difference is cheaper in the run */
+			n = 0;
+			while ((i + n < size) && (n < RAW_MAX)
+					&& (!IS_SMALL(img[i + n] - ref[i + n])
+					|| ((i + n + 1 < size) && !IS_SMALL(
+					img[i + n + 1] - ref[i + n + 1]))))
+				n++;
+			if (o + 1 + n > max)
+				return 0;
+			out[o++] = TAG_RAW | (n - 1);
+			for (k = 0; k < n; k++)
+				out[o++] = img[i + k] - ref[i + k];
+		}
+
+		i += n;
+	}
+
+	return o;
+}
+
+/*!
+ * Applies a code to the reference image.
+ *
+ * \param	img	The reference image, it is replaced by the new one.
+ * \param	size	The size of the image in bytes.
+ * \param	code	The code, the payload of \ref PMT_VISUAL_DELTA.
+ * \param	len	The length of the code.
+ *
+ * \return	0 on success, -1 if the code does not fit the image. The image
+ * 		is then undefined until the next raw image.
+ */
+int img_delta_decode(uint8_t *img, size_t size, const uint8_t *code,
+		size_t len)
+{
+	size_t i = 0, c = 0, n, k;
+	uint8_t tag, d;
+
+	while (c < len) {
+		tag = code[c++];
+
+		if (tag & TAG_RAW) {
+			n = (tag & 0x7F) + 1;
+			if ((i + n > size) || (c + n > len))
+				return -1;
+			for (k = 0; k < n; k++)
+				img[i++] += code[c++];
+		}
+		else if (tag & TAG_NIBBLE) {
+			n = (tag & 0x3F) + 1;
+			if ((i + n > size) || (c + (n + 1) / 2 > len))
+				return -1;
+			for (k = 0; k < n; k++) {
+				d = (k & 1) ? (code[c++] << 4) : code[c];
+				img[i++] += (uint8_t)((int8_t)d >> 4);
+			}
+			if (n & 1)
+				c++;
+		}
+		else {
+			n = (tag & 0x3F) + 1;
+			if (i + n > size)
+				return -1;
+			i += n;
+		}
+	}
+
+	return (i == size) ? 0 : -1;
+}
+
+/*!
+ * @}
+ */
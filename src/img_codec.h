@@ -0,0 +1,49 @@
+/*!
+ * \file	img_codec.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Delta coding of the images sent with \ref PMT_VISUAL_DELTA.
+ *
+ * The payload codes the difference between the image and the previous one
+ * sent (raw or delta), byte per byte modulo 256. It is a sequence of runs,
+ * each one begins with a tag byte:
+ *	- 0x00 to 0x3F: n + 1 unchanged bytes, no data follows,
+ *	- 0x40 to 0x7F: n + 1 differences between -8 and 7, packed in
+ *	  nibbles, the high nibble first, the last low nibble is 0 if n + 1
+ *	  is odd,
+ *	- 0x80 to 0xFF: n + 1 differences, one byte each,
+ *
+ * where n is the value of the low 6 (respectively 7) bits of the tag.
+ *
+ * This file only uses standard C, the server can compile it to decode the
+ * images.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef IMG_CODEC_H_
+#define IMG_CODEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+size_t img_delta_encode(uint8_t *out, size_t max, const uint8_t *img,
+		const uint8_t *ref, size_t size);
+int img_delta_decode(uint8_t *img, size_t size, const uint8_t *code,
+		size_t len);
+
+#endif /* IMG_CODEC_H_ */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,133 @@
+/*!
+ * \file	img_policy.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * An image is sent while a wheel turns, when the scene changed since the
+ * last image sent, and at least every IMG_KEEP_ALIVE ms so the server knows
+ * the robot is alive.
+ *
+ * The change is measured on a thumbnail: the mean of each block of
+ * IMG_CHANGE_BIN x IMG_CHANGE_BIN bytes. The blocks average out the noise of
+ * the sensor, and the thumbnail of the last image sent is all that is kept.
+ * The scene changed when the mean absolute difference of the blocks reaches
+ * IMG_CHANGE_LEVEL. In the colour formats the bytes are not levels, the
+ * measure is then only a rough one.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <stdlib.h>
+
+#include <motor_led/e_motors.h>
+
+#include "configuration.h"
+#include "scheduler.h"
+#include "img_policy.h"
+
+#if IMG_POLICY == 1
+
+#if IMG_CHANGE_BIN > 16
+#error "IMG_CHANGE_BIN is too large, the sums of a block overflow"
+#endif
+
+/*!
+ * Largest thumbnail, for two bytes per pixel.
+ */
+#define THUMB_W		((2 * IMG_W) / IMG_CHANGE_BIN)
+#define THUMB_H		(IMG_H / IMG_CHANGE_BIN)
+
+static unsigned char thumb[THUMB_H][THUMB_W];	/*!< Of the last image sent */
+static unsigned char next[THUMB_H][THUMB_W];	/*!< Of the image checked */
+static unsigned int sums[THUMB_W];	/*!< Sums of the blocks of a row */
+static unsigned int last_time;	/*!< sched_time() of the last image sent */
+static int first;		/*!< No image was sent yet */
+
+/*!
+ * Fills next with the block means of an image. The pixels that do not fill
+ * a block are left out.
+ */
+static void make_thumb(const unsigned char *p, int width, int cols, int rows)
+{
+	int bx, by, x, y;
+
+	for (by = 0; by < rows; by++) {
+		for (bx = 0; bx < cols; bx++)
+			sums[bx] = 0;
+		for (y = 0; y < IMG_CHANGE_BIN; y++) {
+			for (bx = 0; bx < cols; bx++)
+				for (x = 0; x < IMG_CHANGE_BIN; x++)
+					sums[bx] += *p++;
+			p += width - cols * IMG_CHANGE_BIN;
+		}
+		for (bx = 0; bx < cols; bx++)
+			next[by][bx] = sums[bx]
+				/ (IMG_CHANGE_BIN * IMG_CHANGE_BIN);
+	}
+}
+
+/*!
+ * Forgets the last image sent, the next one is sent.
+ */
+void img_policy_init(void)
+{
+	first = 1;
+}
+
+/*!
+ * Decides whether an image is sent. If it is, it becomes the reference of
+ * the next ones.
+ *
+ * \param	img	The image.
+ * \param	width	Bytes per row.
+ * \param	height	Number of rows.
+ *
+ * \return	Non-zero if the image is sent.
+ */
+int img_policy_check(const char *img, int width, int height)
+{
+	int cols = width / IMG_CHANGE_BIN, rows = height / IMG_CHANGE_BIN;
+	unsigned long diff = 0;
+	int send, bx, by;
+
+	if (cols > THUMB_W)
+		cols = THUMB_W;
+	if (rows > THUMB_H)
+		rows = THUMB_H;
+	make_thumb((const unsigned char *)img, width, cols, rows);
+
+	send = first || (sched_time() - last_time >= IMG_KEEP_ALIVE);
+#if DBG_INCLUDE_MOTION == 1
+	send = send || e_motors_running();
+#endif	/* DBG_INCLUDE_MOTION */
+	if (!send) {
+		for (by = 0; by < rows; by++)
+			for (bx = 0; bx < cols; bx++)
+				diff += abs(next[by][bx] - thumb[by][bx]);
+		send = diff >= (unsigned long)rows * cols * IMG_CHANGE_LEVEL;
+	}
+	if (!send)
+		return 0;
+
+	for (by = 0; by < rows; by++)
+		for (bx = 0; bx < cols; bx++)
+			thumb[by][bx] = next[by][bx];
+	first = 0;
+	last_time = sched_time();
+	return 1;
+}
+
+#endif	/* IMG_POLICY */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,32 @@
+/*!
+ * \file	img_policy.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Capture policy: decides which of the captured images are sent, so that a
+ * robot standing still in front of a static scene leaves the link to the
+ * others.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef IMG_POLICY_H_
+#define IMG_POLICY_H_
+
+void img_policy_init(void);
+int img_policy_check(const char *img, int width, int height);
+
+#endif /* IMG_POLICY_H_ */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,74 @@
+/*!
+ * \file	interrupts.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Each driver sets a priority for its interrupts when it is initialized, so
+ * the result depended on the order of the initializations. irq_init() runs
+ * after all of them and sets every priority from the table instead.
+ *
+ * An interrupt delays the ones of lower priority by its longest run, which
+ * PMT_STATS reports per interrupt (max). The delays the timer interrupts
+ * actually see at their entry are reported as well (latency). The camera
+ * line is only delayed by the sections at IPL 7, there are none: the
+ * critical sections stop at IRQ_PRIO_MASK and DISI does not mask level 7.
+ * Since the shadow registers only hold one level, the camera line is the
+ * only interrupt that uses them.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <p30F6014A.h>
+
+#include "configuration.h"
+#include "interrupts.h"
+
+#if IRQ_PRIO_CAM_LINE != 7
+#error "The camera line must have the highest priority"
+#endif
+#if (IRQ_PRIO_CAM_FRAME >= IRQ_PRIO_CAM_LINE) \
+		|| (IRQ_PRIO_MASK >= IRQ_PRIO_CAM_LINE)
+#error "Only the camera line may be at the highest priority"
+#endif
+#if (IRQ_PRIO_UART > IRQ_PRIO_MASK) || (IRQ_PRIO_I2C > IRQ_PRIO_MASK) \
+		|| (IRQ_PRIO_MOTORS > IRQ_PRIO_MASK) \
+		|| (IRQ_PRIO_PROFILE > IRQ_PRIO_MASK) \
+		|| (IRQ_PRIO_ADC > IRQ_PRIO_MASK) \
+		|| (IRQ_PRIO_TICK > IRQ_PRIO_MASK) \
+		|| (IRQ_PRIO_WAKE > IRQ_PRIO_MASK)
+#error "The critical sections must mask the interrupts of the main loop"
+#endif
+
+/*!
+ * Enables the nesting and sets the priorities of all the interrupts used,
+ * after the drivers are initialized.
+ */
+void irq_init(void)
+{
+	INTCON1bits.NSTDIS = 0;
+	IPC5bits.T4IP = IRQ_PRIO_CAM_LINE;
+	IPC5bits.T5IP = IRQ_PRIO_CAM_FRAME;
+	IPC2bits.U1RXIP = IRQ_PRIO_UART;
+	IPC2bits.U1TXIP = IRQ_PRIO_UART;
+	IPC6bits.U2RXIP = IRQ_PRIO_UART;
+	IPC6bits.U2TXIP = IRQ_PRIO_UART;
+	IPC3bits.MI2CIP = IRQ_PRIO_I2C;
+	IPC1bits.T3IP = IRQ_PRIO_MOTORS;
+	IPC1bits.T2IP = IRQ_PRIO_PROFILE;
+	IPC2bits.ADIP = IRQ_PRIO_ADC;
+	IPC0bits.T1IP = IRQ_PRIO_TICK;
+	IPC3bits.CNIP = IRQ_PRIO_WAKE;
+}
+
+/*!
+ * @}
+ */
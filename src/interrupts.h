@@ -0,0 +1,29 @@
+/*!
+ * \file	interrupts.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * The priorities of all the interrupts, from the table in configuration.h.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef INTERRUPTS_H_
+#define INTERRUPTS_H_
+
+void irq_init(void);
+
+#endif /* INTERRUPTS_H_ */
+
+/*!
+ * @}
+ */
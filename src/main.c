@@ -16,8 +16,8 @@
  * header file.
  *
  * Timer usage:
- *	- Timer 1: used by proximity sensors,
- *	- Timer 2: UNUSED,
+ *	- Timer 1: used by the scheduler (1 ms tick),
+ *	- Timer 2: used by the profiling (DBG_INCLUDE_PROFILE),
  *	- Timer 3: used by motor control,
  *	- Timer 4: used by camera,
  *	- Timer 5: used by camera.
@@ -37,32 +37,225 @@
 #include <motor_led/e_epuck_ports.h>
 #include <motor_led/e_init_port.h>
 #include <motor_led/e_motors.h>
-#include <a_d/e_prox.h>
-#include <a_d/e_ad_conv.h>
+#include <a_d/advance_ad_scan/e_prox.h>
+#include <a_d/advance_ad_scan/e_ad_conv.h>
+#include <a_d/advance_ad_scan/e_acc.h>
 #include <uart/e_uart_char.h>
 #include <camera/fast_2_timer/e_poxxxx.h>
+#include <camera/fast_2_timer/e_frame_pool.h>
+#include <image/e_image.h>
+#include <profile/e_profile.h>
 
 #include <pucom.h>
+#include "pucom_ext.h"
 
 #include "configuration.h"
 #include "utility.h"
+#include "odometry.h"
+#include "navigation.h"
+#include "bearing.h"
+#include "scheduler.h"
+#include "img_codec.h"
+#include "img_policy.h"
+#include "power.h"
+#include "interrupts.h"
+#include "slot.h"
+#include "params.h"
+
+/*!
+ * Bytes per pixel of the camera, two in the colour modes.
+ */
+#define IMG_BPP			((CAM_MODE == GREY_SCALE_MODE) ? 1 : 2)
 
 /*!
  * Size of one image in bytes.
- *
- * The bytes per pixel depend on the camera configuration and are currently set
- * to one (grayscale).
  */
-#define IMG_DATA_SIZE		(IMG_H * IMG_W)
+#define IMG_DATA_SIZE		(IMG_H * IMG_W * IMG_BPP)
 
-struct img_buf {
-	/*!
-	 * 0 - the message has been transmitted,
-	 * 1 - the message has NOT yet been transmitted.
-	 */
-	uint8_t data_is_new;	/*!< Indicates the state of the buffer */
-	char data[IMG_DATA_SIZE];	/*!< Image data array */
-};
+/*
+ * The format of the images sent, derived from configuration.h.
+ */
+#if (IMG_PACK == 1) && (CAM_MODE == RGB_565_MODE)
+#define IMG_FORMAT		PPF_RGB332
+#define IMG_TX_SIZE		(IMG_H * IMG_W)	/*!< Bytes of the largest image */
+#else
+#if CAM_MODE == RGB_565_MODE
+#define IMG_FORMAT		PPF_RGB565
+#elif CAM_MODE == YUV_MODE
+#define IMG_FORMAT		PPF_YUV422
+#else
+#define IMG_FORMAT		PPF_GREY
+#endif
+#define IMG_TX_SIZE		IMG_DATA_SIZE
+#endif
+#define IMG_TX_BPP		(IMG_TX_SIZE / (IMG_H * IMG_W))	/*!< Bytes per pixel */
+
+/*
+ * How the images are sent, derived from configuration.h.
+ */
+#define TX_MODE_RAW		0	/*!< PMT_VISUAL */
+#define TX_MODE_DELTA		1	/*!< PMT_VISUAL_DELTA when shorter */
+#define TX_MODE_ROWS		2	/*!< PMT_VISUAL_ROWS during the capture */
+#define TX_MODE_PROFILE		3	/*!< PMT_VISUAL_PROFILE */
+#define TX_MODE_BLOB		4	/*!< PMT_VISUAL_BLOB */
+
+#if IMG_STREAM == 1
+#define TX_MODE			TX_MODE_ROWS
+#elif IMG_RESULT == IMG_RESULT_PROFILE
+#define TX_MODE			TX_MODE_PROFILE
+#elif IMG_RESULT == IMG_RESULT_BLOB
+#define TX_MODE			TX_MODE_BLOB
+#elif IMG_DELTA == 1
+#define TX_MODE			TX_MODE_DELTA
+#else
+#define TX_MODE			TX_MODE_RAW
+#endif
+
+#if (TX_MODE == TX_MODE_ROWS) && (DBG_INCLUDE_CAM != 1)
+#error "IMG_STREAM needs the camera"
+#endif
+#if (TX_MODE == TX_MODE_PROFILE || TX_MODE == TX_MODE_BLOB) \
+		&& (CAM_MODE != GREY_SCALE_MODE)
+#error "IMG_RESULT needs grayscale images"
+#endif
+#if (DBG_INCLUDE_CAM == 1) && ((IMG_W * IMG_SS > ARRAY_WIDTH) \
+		|| (IMG_H * IMG_SS > ARRAY_HEIGHT))
+#error "The area of interest does not fit the sensor"
+#endif
+#if (TX_WINDOW > 0) && (TX_MODE == TX_MODE_ROWS)
+#error "TX_WINDOW does not work with IMG_STREAM"
+#endif
+#if (TX_WINDOW > 0) && (DBG_INCLUDE_CAM == 1) && (TX_WINDOW >= IMG_BUF_COUNT)
+#error "TX_WINDOW needs more image buffers"
+#endif
+#if (SENSORS_PERIOD > 0) && (DBG_INCLUDE_PROXIMITY != 1)
+#error "SENSORS_PERIOD needs the proximity sensors"
+#endif
+#if (IMG_POLICY == 1) && (TX_MODE == TX_MODE_ROWS)
+#error "IMG_POLICY does not work with IMG_STREAM"
+#endif
+#if (TX_SWARM == 1) && (TX_MODE == TX_MODE_ROWS)
+#error "TX_SWARM does not work with IMG_STREAM"
+#endif
+
+/*!
+ * The image buffers, handed to the frame pool of the camera.
+ */
+static char img_data[IMG_BUF_COUNT][IMG_DATA_SIZE];
+
+/*
+ * The geometry in effect, from the parameters (PP_IMG_W, ...). The buffers
+ * are sized for the one of configuration.h, the largest.
+ */
+static unsigned int img_w;
+static unsigned int img_h;
+static unsigned int img_ss;
+static unsigned int img_row_size;	/*!< Bytes of a row captured */
+static unsigned int img_tx_row_size;	/*!< Bytes of a row sent */
+static unsigned int img_tx_size;	/*!< Bytes of an image sent */
+static int geo_pending = 0;	/*!< The parameters changed the geometry */
+
+/*!
+ * The parameters whose value is to be sent back, one bit per PUCK_PARAMS.
+ */
+static unsigned int param_due = 0;
+static unsigned int param_refused = 0;	/*!< Same bits, the set failed */
+static int param_save_due = 0;	/*!< A save waits for the new geometry */
+
+/*!
+ * Takes the geometry of the parameters.
+ */
+static void geo_read(void)
+{
+	img_w = params_get(PP_IMG_W);
+	img_h = params_get(PP_IMG_H);
+	img_ss = params_get(PP_IMG_SS);
+	img_row_size = img_w * IMG_BPP;
+	img_tx_row_size = img_w * IMG_TX_BPP;
+	img_tx_size = img_h * img_tx_row_size;
+}
+
+static int geo_apply(void);
+
+#if TX_MODE == TX_MODE_ROWS
+/*!
+ * The row indexes sent before each row of PMT_VISUAL_ROWS.
+ */
+static uint8_t row_index[IMG_H];
+#elif TX_MODE == TX_MODE_DELTA
+/*!
+ * The code of the image being sent as PMT_VISUAL_DELTA.
+ */
+static uint8_t img_code[IMG_DELTA_MAX];
+static unsigned int key_cnt = 0;	/*!< Deltas since the last raw image */
+#elif TX_MODE == TX_MODE_PROFILE
+/*!
+ * The column sums sent as PMT_VISUAL_PROFILE.
+ */
+static unsigned int img_profile[IMG_W];
+#elif TX_MODE == TX_MODE_BLOB
+/*!
+ * The blob sent as PMT_VISUAL_BLOB, and the work array to find it.
+ */
+static struct e_img_blob img_blob;
+static int img_work[(IMG_W > IMG_H) ? IMG_W : IMG_H];
+#endif	/* TX_MODE */
+
+#if TX_MODE != TX_MODE_ROWS
+/*!
+ * Last image sent, the reference of the next PMT_VISUAL_DELTA. It stays NULL
+ * in the other modes.
+ */
+static char *ref_img = NULL;
+#endif	/* TX_MODE */
+
+#if DBG_INCLUDE_CAM == 1
+/*!
+ * Takes the oldest captured image, NULL if there is none.
+ */
+#define get_img()		e_poxxxx_pool_get_ready()
+/*!
+ * Gives an image back to the camera once it has been transmitted.
+ */
+#define release_img(img)	e_poxxxx_pool_release(img)
+#else	/* Real CAM is disabled, so here is a dummy */
+/*!
+ * Camera is not included, so generate a fixed image.
+ */
+static char *get_img(void)
+{
+	int i;
+
+	for (i = 0; i < IMG_DATA_SIZE; i++)
+		img_data[0][i] = i;
+	return img_data[0];
+}
+#define release_img(img)
+#endif	/* DBG_INCLUDE_CAM */
+
+#if TX_MODE != TX_MODE_ROWS
+/*!
+ * Takes the oldest captured image like get_img(), packed in place to the
+ * format sent. With IMG_POLICY, an image that is not to be sent is given
+ * back to the camera and NULL is returned.
+ */
+static char *take_img(void)
+{
+	char *img = get_img();
+
+#if IMG_FORMAT == PPF_RGB332
+	if (img != NULL)
+		e_img_pack_rgb332(img, img_w * img_h);
+#endif	/* IMG_FORMAT */
+#if IMG_POLICY == 1
+	if ((img != NULL) && !img_policy_check(img, img_tx_row_size, img_h)) {
+		release_img(img);
+		return NULL;
+	}
+#endif	/* IMG_POLICY */
+	return img;
+}
+#endif	/* TX_MODE */
 
 /*!
  * These are the bit mask values for the puck's program selector.
@@ -79,9 +272,19 @@ enum TRANSMISSION_STATES {
 	TX_INIT,	/*!< Initialization */
 	TX_CONFIG,	/*!< Send PMT_CONFIG message */
 	TX_CONFIG_ACK,	/*!< Wait for server acknowledgment */
-	TX_VISUAL,	/*!< Check for available buffer and send PMT_VISUAL */
+	TX_VISUAL,	/*!< Check for available image and send PMT_VISUAL */
 	TX_VISUAL_ACK,	/*!< Wait for server acknowledgment */
-	TX_VISUAL_SENT	/*!< Wait until the data was sent */
+	TX_VISUAL_ROWS,	/*!< Send the rows as they are captured */
+	TX_VISUAL_SENT,	/*!< Wait until the data was sent */
+	TX_MSG_ACK	/*!< Wait for server acknowledgment of a short message */
+};
+
+/*!
+ * The states of the telemetry FSM on UART2.
+ */
+enum TELEMETRY_STATES {
+	TEL_IDLE,	/*!< Send an acknowledgment or a short message */
+	TEL_ACK		/*!< Wait for server acknowledgment of the header */
 };
 
 /*!
@@ -89,155 +292,716 @@ enum TRANSMISSION_STATES {
  */
 enum CAMERA_STATES {
 	CAM_INACTIVE, /*!< Camera inactive */
-	CAM_IDLE,	/*!< Image capture not started */
-	CAM_CAPTURING	/*!< Image capture in progress */
+	CAM_ACTIVE,	/*!< Continuous capture into the frame pool */
+	CAM_STOPPING	/*!< Wait for the last capture before the standby */
 };
 
 /*!
- * The states of the motion FSM.
+ * Period of the selector task in ms.
  */
-enum MOTION_STATES {
-	MOT_INIT,	/*!< Initialization, move forward */
-	MOT_FORWARDS,	/*!< Move forward */
-	MOT_TURN_LEFT,	/*!< Turn left */
-	MOT_TURN_RIGHT,	/*!< Turn right */
-	MOT_STOP	/*!< Motors are stopped */
-};
+#define SEL_PERIOD		50
 
-int main(void)
-{
-	int prox_values[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-	int closest, closest_index, i, sel = 0;
-	unsigned char act_tx_buf = 0, act_img_buf = 0, ack = 0;
-	int tx_state, img_state, move_state;
-	struct img_buf img_bufs[2];
-	struct puck_msg_hdr msg_hdr;
-	struct puck_msg_config msg_config;
+/*!
+ * Period of the tasks that also run without event, in ms.
+ */
+#define TASK_PERIOD		100
+
+/*!
+ * Period of the telemetry task in ms, the short messages are due on time.
+ */
+#define TEL_PERIOD		10
+
+/*!
+ * Period of the transmission task in ms, in a swarm it must see its slot
+ * begin.
+ */
+#if TX_SWARM == 1
+#define TX_PERIOD		TEL_PERIOD
+#else
+#define TX_PERIOD		TASK_PERIOD
+#endif	/* TX_SWARM */
 
-	img_bufs[0].data_is_new = 0;
-	img_bufs[1].data_is_new = 0;
+/*
+ * The longest messages, header included, for the time left in the slot.
+ */
+#if TX_MODE == TX_MODE_PROFILE
+#define TX_IMG_PAYLOAD		(img_w * sizeof(uint16_t))
+#elif TX_MODE == TX_MODE_BLOB
+#define TX_IMG_PAYLOAD		sizeof(struct puck_msg_blob)
+#else
+#define TX_IMG_PAYLOAD		img_tx_size
+#endif	/* TX_MODE */
+#define TX_IMG_MAX		(sizeof(struct puck_msg_hdr)		\
+					+ sizeof(struct puck_msg_id)	\
+					+ sizeof(struct puck_msg_seq)	\
+					+ TX_IMG_PAYLOAD)
+#define TX_SHORT_MAX		(sizeof(struct puck_msg_hdr)		\
+					+ sizeof(struct puck_msg_stats))
+#define TX_CONFIG_MAX		(sizeof(struct puck_msg_hdr)		\
+					+ sizeof(struct puck_msg_config))
 
-	tx_state = TX_INIT;
-	img_state = CAM_INACTIVE;
-	move_state = MOT_INIT;
+static int sel = 0;		/*!< The position of the program selector */
+static int prox_values[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+/*!
+ * Reads the program selector.
+ */
+static void sel_task(unsigned int events)
+{
+	(void)events;
+#if DBG_BENCHMARK == 1
+	sel = SEL_SENSING;
+#else
+	sel = get_selector();
+#endif	/* DBG_BENCHMARK */
+}
 
-	/* Initialization */
-	e_init_port();
 #if DBG_INCLUDE_PROXIMITY == 1
-	e_init_prox();
+/*!
+ * Reads the filtered proximity values and determines which sensor sees the
+ * closest object, when they changed.
+ */
+static void prox_task(unsigned int events)
+{
+	static unsigned int cycle = 0;
+	int closest = 0, closest_index = 0, i;
+
+	(void)events;
+
+	if (e_get_prox_changed(prox_values, &cycle) == 0)
+		return;
+	for (i = 0; i < 8; i++) {
+		if (prox_values[i] > closest) {
+			closest = prox_values[i];
+			closest_index = i;
+		}
+	}
+
+	/*
+	 * Indicate the direction of the closest object by
+	 * turning on the LED facing it.
+	 */
+	e_set_led_mask(1 << closest_index);
+}
 #endif	/* DBG_INCLUDE_PROXIMITY */
+
+#if DBG_INCLUDE_ODOMETRY == 1
+/*!
+ * Integrates the motor steps into the pose.
+ */
+static void odo_task(unsigned int events)
+{
+	(void)events;
+	odo_update();
+}
+#endif	/* DBG_INCLUDE_ODOMETRY */
+
+#if DBG_INCLUDE_BEARING == 1
+/*!
+ * Estimates the bearing to the beacon from the last microphone block.
+ */
+static void bearing_task(unsigned int events)
+{
+	(void)events;
+	bearing_update();
+}
+#endif	/* DBG_INCLUDE_BEARING */
+
 #if DBG_INCLUDE_MOTION == 1
-	e_init_motors();
+/*!
+ * The motion and obstacle avoidance, it runs after each proximity cycle.
+ * The wheel speeds follow the proximity values, see navigation.h. While the
+ * motion is disabled, the proximity cycles are slowed down.
+ */
+static void motion_task(unsigned int events)
+{
+	static int left = 0, right = 0;
+	int l = 0, r = 0;
+
+	(void)events;
+
+	if (sel & SEL_MOTION) {
+		nav_speeds(prox_values, &l, &r);
+		e_ad_set_prox_wait(0);
+	}
+	else {
+		e_ad_set_prox_wait(PROX_WAIT_SCANS);
+	}
+	if ((l != left) || (r != right)) {
+		left = l;
+		right = r;
+		setSpeeds(left, right);
+	}
+}
 #endif	/* DBG_INCLUDE_MOTION */
+
 #if DBG_INCLUDE_TRANSMISSION == 1
-	e_init_uart1();
-#endif	/* DBG_INCLUDE_TRANSMISSION */
-#if DBG_INCLUDE_CAM == 1
-	e_poxxxx_init_cam();
-	e_poxxxx_config_cam((ARRAY_WIDTH - (IMG_W * IMG_SS))/2,
-			(ARRAY_HEIGHT - (IMG_H * IMG_SS))/2, IMG_W * IMG_SS,
-			IMG_H * IMG_SS, IMG_SS, IMG_SS, CAM_MODE);
-	e_poxxxx_write_cam_registers();
-#endif	/* DBG_INCLUDE_CAM */
+#if TX_MODE != TX_MODE_ROWS
+/*!
+ * Prepares the message of a captured image.
+ *
+ * \param	img	The image.
+ * \param	ref	The image the server has before, NULL to send a raw one.
+ * \param	hdr	The header to fill in.
+ *
+ * \return	The payload of the message.
+ */
+static const char *code_img(char *img, const char *ref,
+		struct puck_msg_hdr *hdr)
+{
+#if TX_MODE == TX_MODE_DELTA
+	size_t len;
 
-	/* Safety wait period to prevent UART clogging */
-	myWait(500);
+	if ((ref != NULL) && (key_cnt < IMG_KEY_INTERVAL)
+			&& ((len = img_delta_encode(img_code, sizeof(img_code),
+				(uint8_t *)img, (const uint8_t *)ref,
+				img_tx_size)) != 0)) {
+		hdr->type = PMT_VISUAL_DELTA;
+		hdr->len = len;
+		key_cnt++;
+		return (char *)img_code;
+	}
+	key_cnt = 0;
+#elif TX_MODE == TX_MODE_PROFILE
+	e_img_col_sum(img, img_w, img_h, img_profile);
+	hdr->type = PMT_VISUAL_PROFILE;
+	hdr->len = img_w * sizeof(img_profile[0]);
+	return (char *)img_profile;
+#elif TX_MODE == TX_MODE_BLOB
+	e_img_blob(img, img_w, img_h, IMG_BLOB_THRESHOLD, &img_blob, img_work);
+	hdr->type = PMT_VISUAL_BLOB;
+	hdr->len = sizeof(img_blob);
+	return (char *)&img_blob;
+#endif	/* TX_MODE */
+	hdr->type = PMT_VISUAL;
+	hdr->len = img_tx_size;
+	return img;
+}
+#endif	/* TX_MODE */
 
-	/* Selector in position 0 lets the e-Puck wait at the start. */
-	do {
-		sel = get_selector();
-		myWait(500);
-	} while (sel == 0);
+#if DBG_INCLUDE_PROFILE == 1
+/*!
+ * The time spent in each state of the transmission FSM.
+ */
+static struct e_prof_fsm tx_prof;
 
-	while (1) {
-		sel = get_selector();
+/*!
+ * Fills a PMT_STATS payload.
+ *
+ * \param	msg	The payload.
+ * \param	fsm	The states of the transmission FSM.
+ */
+static void get_stats(struct puck_msg_stats *msg, const struct e_prof_fsm *fsm)
+{
+	struct e_prof_stat stat;
+	int i;
 
-#if DBG_INCLUDE_PROXIMITY == 1
-		/*
-		 * Determine which sensor sees the closest object.
-		 */
-		closest = 0;
-		for (i = 0; i < 8; i++) {
-			prox_values[i] = e_get_prox(i);
-			if (prox_values[i] > closest) {
-				closest = prox_values[i];
-				closest_index = i;
-			}
-		}
+	msg->time = e_prof_time();
+	for (i = 0; i < E_PROF_NB; i++) {
+		e_prof_read(&e_prof_isr[i], &stat);
+		msg->isr[i].count = stat.count;
+		msg->isr[i].max = stat.max;
+		msg->isr[i].total = stat.total;
+	}
+	e_prof_read(&e_prof_loop, &stat);
+	msg->loop.count = stat.count;
+	msg->loop.max = stat.max;
+	msg->loop.total = stat.total;
+	for (i = 0; i < E_PROF_FSM_STATES; i++)
+		msg->tx_state[i] = fsm->time[i];
+	for (i = 0; i < E_PROF_LAT_NB; i++)
+		msg->latency[i] = e_prof_read_latency(i);
+}
+#endif	/* DBG_INCLUDE_PROFILE */
 
-		/*
-		 * Indicate the direction of the closest object by
-		 * turning on the LED facing it.
-		 */
-		allRedLEDsOff();
-		setLED(closest_index, 1);
-#endif	/* DBG_INCLUDE_PROXIMITY */
+#if SENSORS_PERIOD > 0
+/*!
+ * Fills a PMT_SENSORS payload with the current values.
+ *
+ * \param	msg	The payload.
+ */
+static void get_sensors(struct puck_msg_sensors *msg)
+{
+	long left, right;
+	int x, y, z, i;
+
+	msg->time = sched_time();
+	for (i = 0; i < 8; i++) {
+		msg->prox[i] = prox_values[i];
+		msg->ambient[i] = e_get_ambient_light(i);
+	}
+	e_get_acc(&x, &y, &z);
+	msg->acc[0] = x;
+	msg->acc[1] = y;
+	msg->acc[2] = z;
+	e_get_steps_long(&left, &right);
+	msg->steps[0] = left;
+	msg->steps[1] = right;
+}
+#endif	/* SENSORS_PERIOD */
 
+/*!
+ * Takes the value of a parameter that was set. A new geometry waits until
+ * the transmission gave all the images back.
+ */
+static void param_apply(unsigned int id)
+{
+	switch (id) {
 #if DBG_INCLUDE_MOTION == 1
-		/*
-		 * The motion state machine. This implements the puck's
-		 * motion and obstacle avoidance.
-		 */
-		switch (move_state) {
-		case MOT_INIT:
-			if ((sel & SEL_MOTION) == 0) {
-				setSpeeds(0, 0);
-				move_state = MOT_STOP;
-			}
-			else {
-				setSpeeds(MOVING_SPEED, MOVING_SPEED);
-				move_state = MOT_FORWARDS;
-			}
+	case PP_MOVING_SPEED:
+		nav_set_speed(params_get(id));
+		break;
+	case PP_MOTION_ACCEL:
+		e_set_acceleration(params_get(id));
+		break;
+#endif	/* DBG_INCLUDE_MOTION */
+	case PP_IMG_W:
+	case PP_IMG_H:
+	case PP_IMG_SS:
+		geo_pending = 1;
+		break;
+	}
+}
+
+/*!
+ * Handles a PMT_PARAM of the server, its answer is due. A save blocks a few
+ * ms per parameter that changed.
+ *
+ * \param	msg	The payload of the message.
+ */
+static void param_recv(const struct puck_msg_param *msg)
+{
+	if (msg->id >= PP_COUNT)
+		return;
+	if (msg->flags & PARAM_SET) {
+		if (params_set(msg->id, msg->value))
+			param_apply(msg->id);
+		else
+			param_refused |= 1 << msg->id;
+	}
+	if (msg->flags & PARAM_SAVE) {
+		/* a geometry is only saved once the camera took it */
+		if (geo_pending)
+			param_save_due = 1;
+		else
+			params_save();
+	}
+	param_due |= 1 << msg->id;
+}
+
+/*!
+ * Prepares the short message that is due: the answers to PMT_PARAM, once a
+ * new geometry is applied, then the pose before the sensors and the stats.
+ *
+ * \param	hdr	The header to fill in.
+ *
+ * \return	The payload of the message, NULL if none is due.
+ */
+static const char *short_msg(struct puck_msg_hdr *hdr)
+{
+	static struct puck_msg_param msg_param;
+#if DBG_INCLUDE_ODOMETRY == 1
+	static struct puck_msg_pose msg_pose;
+	static unsigned int pose_time = 0;	/* when the last pose was sent */
+#endif	/* DBG_INCLUDE_ODOMETRY */
+#if SENSORS_PERIOD > 0
+	static struct puck_msg_sensors msg_sensors;
+	static unsigned int sensors_time = 0;	/* when the last were sent */
+#endif	/* SENSORS_PERIOD */
+#if DBG_INCLUDE_PROFILE == 1
+	static struct puck_msg_stats msg_stats;
+	static unsigned int stats_time = 0;	/* when the last stats were sent */
+#endif	/* DBG_INCLUDE_PROFILE */
+	unsigned int id;
+
+	if ((param_due != 0) && !geo_pending) {
+		for (id = 0; (param_due & (1 << id)) == 0; id++)
+			;
+		param_due &= ~(1 << id);
+		msg_param.id = id;
+		msg_param.flags = (param_refused & (1 << id)) ? PARAM_REFUSED : 0;
+		param_refused &= ~(1 << id);
+		msg_param.value = params_get(id);
+		hdr->type = PMT_PARAM;
+		hdr->len = sizeof(msg_param);
+		return (char *)&msg_param;
+	}
+#if DBG_INCLUDE_ODOMETRY == 1
+	if (sched_time() - pose_time >= POSE_PERIOD) {
+		pose_time = sched_time();
+		odo_get_msg(&msg_pose);
+		hdr->type = PMT_POSE;
+		hdr->len = sizeof(msg_pose);
+		return (char *)&msg_pose;
+	}
+#endif	/* DBG_INCLUDE_ODOMETRY */
+#if SENSORS_PERIOD > 0
+	if (sched_time() - sensors_time >= SENSORS_PERIOD) {
+		sensors_time = sched_time();
+		get_sensors(&msg_sensors);
+		hdr->type = PMT_SENSORS;
+		hdr->len = sizeof(msg_sensors);
+		return (char *)&msg_sensors;
+	}
+#endif	/* SENSORS_PERIOD */
+#if DBG_INCLUDE_PROFILE == 1
+	if (sched_time() - stats_time >= STATS_PERIOD) {
+		stats_time = sched_time();
+		get_stats(&msg_stats, &tx_prof);
+		hdr->type = PMT_STATS;
+		hdr->len = sizeof(msg_stats);
+		return (char *)&msg_stats;
+	}
+#endif	/* DBG_INCLUDE_PROFILE */
+	return NULL;
+}
+
+#if TX_WINDOW > 0
+/*
+ * The images sent as PMT_VISUAL_SEQ and not acknowledged yet. They stay in
+ * their buffers, so that they can be sent again.
+ */
+static char *win_img[TX_WINDOW];	/*!< Oldest first */
+static unsigned int win_count = 0;	/*!< Number of images in the window */
+static unsigned int win_sent = 0;	/*!< Images sent since the timeout */
+static uint8_t win_base = 0;		/*!< Sequence number of win_img[0] */
+static unsigned int win_time;		/*!< When the window last moved */
+
+/*!
+ * Empties the window, the next image has the sequence number 0.
+ */
+static void win_reset(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < win_count; i++)
+		release_img(win_img[i]);
+	win_count = 0;
+	win_sent = 0;
+	win_base = 0;
+}
+
+/*!
+ * Takes a cumulative acknowledgment. The images before next arrived, their
+ * buffers go back to the camera, except the last one sent: it is the
+ * reference of the next delta.
+ *
+ * \param	next	The sequence number the server waits for.
+ */
+static void win_ack(uint8_t next)
+{
+	unsigned int n = (uint8_t)(next - win_base), i;
+
+	if ((n == 0) || (n > win_count))
+		return;		/* old or out of the window */
+	/*
+	 * An image still being sent again goes back too, it is a duplicate
+	 * and the server drops it.
+	 */
+	if (ref_img != NULL)
+		release_img(ref_img);
+	ref_img = NULL;
+	for (i = 0; i < n; i++) {
+#if TX_MODE == TX_MODE_DELTA
+		if (i == win_count - 1) {
+			ref_img = win_img[i];
+			continue;
+		}
+#endif	/* TX_MODE */
+		release_img(win_img[i]);
+	}
+	for (i = n; i < win_count; i++)
+		win_img[i - n] = win_img[i];
+	win_count -= n;
+	win_sent = (win_sent > n) ? win_sent - n : 0;
+	win_base = next;
+	win_time = sched_time();
+}
+
+/*!
+ * Sends the image win_img[win_sent], header and payload back to back.
+ *
+ * \param	ref	The image the server has before, NULL to send a raw one.
+ */
+static void win_send(const char *ref)
+{
+	static struct puck_msg_hdr hdr, img_hdr;
+	static struct puck_msg_seq seq;
+#if TX_SWARM == 1
+	static struct puck_msg_id id;
+#endif	/* TX_SWARM */
+	struct e_uart_seg segs[4];
+	const char *data;
+	int n = 0;
+
+	data = code_img(win_img[win_sent], ref, &img_hdr);
+	seq.seq = win_base + win_sent;
+	seq.type = img_hdr.type;
+	hdr.type = PMT_VISUAL_SEQ;
+	hdr.len = sizeof(seq) + img_hdr.len;
+	segs[n].buff = (char *)&hdr;
+	segs[n++].length = sizeof(hdr);
+#if TX_SWARM == 1
+	if (slot_mark(&hdr, &id)) {
+		segs[n].buff = (char *)&id;
+		segs[n++].length = sizeof(id);
+	}
+#endif	/* TX_SWARM */
+	segs[n].buff = (char *)&seq;
+	segs[n++].length = sizeof(seq);
+	segs[n].buff = data;
+	segs[n++].length = img_hdr.len;
+	e_send_uart1_segs(segs, n);
+	slot_count_image();
+	win_sent++;
+}
+
+/*!
+ * Sends the next image of the window, again after a timeout, or a new one
+ * if the window is not full. The transmission must be idle, the payloads
+ * of the image processing are not double buffered.
+ *
+ * \return	Whether an image was sent.
+ */
+static int win_poll(void)
+{
+	char *img;
+
+	if ((win_count > 0) && (sched_time() - win_time >= TX_ACK_TIMEOUT)) {
+		/* go back to the oldest, the server dropped the next ones */
+		win_sent = 0;
+		win_time = sched_time();
+	}
+	if (!slot_fits(TX_IMG_MAX, 1))
+		return 0;
+	if (win_sent < win_count) {
+		/* the first one again is raw, its reference may be gone */
+		win_send((win_sent > 0) ? win_img[win_sent - 1] : NULL);
+		return 1;
+	}
+	if ((win_count < TX_WINDOW) && ((img = take_img()) != NULL)) {
+		if (win_count == 0)
+			win_time = sched_time();
+		win_img[win_count++] = img;
+		win_send((win_count > 1) ? win_img[win_count - 2] : ref_img);
+		return 1;
+	}
+	return 0;
+}
+#endif	/* TX_WINDOW */
+
+#if (TX_SWARM == 1) && (TX_WINDOW == 0)
+/*!
+ * Sends an image message as a PMT_VISUAL_ID once the robot has a slot,
+ * header and payload back to back. The server acknowledges the whole
+ * message.
+ *
+ * \param	hdr	The header of the message, it becomes the header of the
+ *			PMT_VISUAL_ID.
+ * \param	data	The payload of the message.
+ *
+ * \return	Whether the message was sent, else only the header is due.
+ */
+static int send_marked(struct puck_msg_hdr *hdr, const char *data)
+{
+	static struct puck_msg_id id;
+	struct e_uart_seg segs[3];
+
+	if (!slot_mark(hdr, &id))
+		return 0;
+	segs[0].buff = (char *)hdr;
+	segs[0].length = sizeof(*hdr);
+	segs[1].buff = (char *)&id;
+	segs[1].length = sizeof(id);
+	segs[2].buff = data;
+	segs[2].length = hdr->len - sizeof(id);
+	e_send_uart1_segs(segs, 3);
+	return 1;
+}
+#endif	/* TX_SWARM */
+
+/*!
+ * A UART the server sends on.
+ */
+struct rx_port {
+	int (*peek)(char *buff, int max);
+	int (*avail)();
+	int (*read)(char *buff, int max);
+	int ack_pending;	/*!< A message of the server must be acknowledged */
+};
+
+static struct rx_port rx_uart1 = {
+	e_peek_uart1, e_ischar_uart1, e_read_uart1, 0
+};
+#if TX_UART2 == 1
+static struct rx_port rx_uart2 = {
+	e_peek_uart2, e_ischar_uart2, e_read_uart2, 0
+};
+#endif	/* TX_UART2 */
+
+/*!
+ * Reads the received bytes. The messages of the server are handled as soon
+ * as they are complete, the other bytes are dropped.
+ *
+ * \param	port	The UART to read.
+ *
+ * \return	Whether a PMT_ACK byte was received.
+ */
+static int rx_poll(struct rx_port *port)
+{
+	static struct puck_msg_hdr hdr;
+	static struct puck_msg_nav nav;
+	static struct puck_msg_seq_ack seq_ack;
+	static struct puck_msg_param param;
+#if TX_SWARM == 1
+	static struct puck_msg_slot slot;
+#endif	/* TX_SWARM */
+	unsigned int len;
+	char c;
+	int acked = 0;
+
+	while (port->peek(&c, 1)) {
+		switch ((unsigned char)c) {
+		case PMT_NAV_WEIGHTS:
+			len = sizeof(nav);
 			break;
-		case MOT_FORWARDS:
-			if ((sel & SEL_MOTION) == 0) {
-				setSpeeds(0, 0);
-				move_state = MOT_STOP;
-			}
-			else if (PATH_OBSTRUCTED_RIGHT()) {
-				setSpeeds(-TURNING_SPEED, TURNING_SPEED);
-				move_state = MOT_TURN_LEFT;
-			}
-			else if (PATH_OBSTRUCTED_LEFT()) {
-				setSpeeds(TURNING_SPEED, -TURNING_SPEED);
-				move_state = MOT_TURN_RIGHT;
-			}
+		case PMT_SEQ_ACK:
+			len = sizeof(seq_ack);
 			break;
-		case MOT_TURN_LEFT:
-			if ((sel & SEL_MOTION) == 0) {
-				setSpeeds(0, 0);
-				move_state = MOT_STOP;
-			}
-			else if (!PATH_OBSTRUCTED_RIGHT()) {
-				setSpeeds(MOVING_SPEED, MOVING_SPEED);
-				move_state = MOT_FORWARDS;
-			}
+		case PMT_PARAM:
+			len = sizeof(param);
 			break;
-		case MOT_TURN_RIGHT:
-			if ((sel & SEL_MOTION) == 0) {
-				setSpeeds(0, 0);
-				move_state = MOT_STOP;
-			}
-			else if (!PATH_OBSTRUCTED_LEFT()) {
-				setSpeeds(MOVING_SPEED, MOVING_SPEED);
-				move_state = MOT_FORWARDS;
-			}
+#if TX_SWARM == 1
+		case PMT_SLOT:
+			len = sizeof(slot);
 			break;
-		case MOT_STOP:
-			if (sel & SEL_MOTION) {
-				move_state = MOT_INIT;
-			}
+#endif	/* TX_SWARM */
+		default:
+			len = 0;
 			break;
 		}
-#endif	/* DBG_INCLUDE_MOTION */
+		if (len != 0) {
+			if (port->peek((char *)&hdr, sizeof(hdr))
+					< (int)sizeof(hdr))
+				break;
+			if (hdr.len == len) {
+				if (port->avail() < (int)(sizeof(hdr) + len))
+					break;
+				port->read((char *)&hdr, sizeof(hdr));
+				if (hdr.type == PMT_NAV_WEIGHTS) {
+					port->read((char *)&nav, len);
+					nav_set_weights(&nav);
+					port->ack_pending = 1;
+				}
+				else if (hdr.type == PMT_PARAM) {
+					port->read((char *)&param, len);
+					param_recv(&param);
+					port->ack_pending = 1;
+				}
+#if TX_SWARM == 1
+				else if (hdr.type == PMT_SLOT) {
+					port->read((char *)&slot, len);
+					slot_set(&slot);
+					port->ack_pending = 1;
+				}
+#endif	/* TX_SWARM */
+				else {
+					port->read((char *)&seq_ack, len);
+#if TX_WINDOW > 0
+					win_ack(seq_ack.next);
+#endif	/* TX_WINDOW */
+				}
+				continue;
+			}
+			/* not a message, the byte is dropped */
+		}
+		port->read(&c, 1);
+		if (c == PMT_ACK)
+			acked = 1;
+	}
+	return acked;
+}
 
-#if DBG_INCLUDE_TRANSMISSION == 1
+/*!
+ * Drops the bytes rx_poll() left in the reception buffer: the start of a
+ * message, or the answers to a message that timed out.
+ *
+ * \param	port	The UART to empty.
+ */
+static void rx_drain(struct rx_port *port)
+{
+	char buff[16];
+
+	while (port->read(buff, sizeof(buff)) > 0)
+		;
+}
+
+/*!
+ * The transmission state machine, it runs when bytes are received, when a
+ * transmission is done or when an image is ready.
+ */
+static void tx_task(unsigned int events)
+{
+	static int tx_state = TX_INIT;
+	static unsigned char ack = 0;
+	static const unsigned char ack_byte = PMT_ACK;
+	static char *tx_img = NULL;	/* image being sent */
+#if TX_MODE == TX_MODE_ROWS
+	static int tx_row;		/* next row to send */
+	int rows;
+#else
+	static const char *tx_data;	/* payload of the message */
+	static int tx_marked = 0;	/* it is sent as a PMT_VISUAL_ID */
+#endif	/* TX_MODE */
+	static struct puck_msg_hdr msg_hdr;
+	static struct puck_msg_config msg_config;
+#if IMG_FORMAT != PPF_GREY
+	static struct puck_msg_format msg_format;
+#endif	/* IMG_FORMAT */
+	static const char *msg_data;	/* payload of a short message */
+	static unsigned int ack_time;	/* when the wait for PMT_ACK began */
+	int prev_state;
+
+	(void)events;
+
+	/*
+	 * Go on as long as the state changes, the next event may be far.
+	 */
+	do {
+		prev_state = tx_state;
+		if (rx_poll(&rx_uart1))
+			ack = PMT_ACK;
+		if (rx_uart1.ack_pending && !e_uart1_sending()
+				&& ((tx_state == TX_INIT)
+					|| (tx_state == TX_VISUAL))) {
+			/* between two messages of ours */
+			e_send_uart1_char((char *)&ack_byte, 1);
+			rx_uart1.ack_pending = 0;
+		}
 		switch (tx_state) {
 		case TX_INIT:
-			/*
-			 * TODO Empty the UART buffers.
-			 */
-			if ((sel & SEL_SENSING)) {
+			ack = 0;	/* of a message that timed out */
+			if (e_uart1_sending())
+				break;
+			if (tx_img != NULL) {
+				release_img(tx_img);
+				tx_img = NULL;
+			}
+#if TX_MODE == TX_MODE_DELTA
+			if (ref_img != NULL) {
+				/* the next image will be raw */
+				release_img(ref_img);
+				ref_img = NULL;
+			}
+#endif	/* TX_MODE */
+#if TX_WINDOW > 0
+			win_reset();
+#endif	/* TX_WINDOW */
+			if (geo_pending && geo_apply())
+				geo_pending = 0;
+			if ((sel & SEL_SENSING) && !geo_pending) {
+				/* the server starts again from the configuration */
+				rx_drain(&rx_uart1);
 				tx_state = TX_CONFIG;
 			}
 			break;
@@ -249,58 +1013,108 @@ int main(void)
 			if ((sel & SEL_SENSING) == 0) {
 				tx_state = TX_INIT;
 			}
-			else if ((sel & SEL_SENSING) && !e_uart1_sending()) {
+			else if ((sel & SEL_SENSING) && !e_uart1_sending()
+					&& slot_fits(TX_CONFIG_MAX, 0)) {
 				msg_hdr.type = PMT_CONFIG;
 				msg_hdr.len = sizeof(msg_config);
-				msg_config.cols = IMG_W;
-				msg_config.rows = IMG_H;
+				msg_config.cols = img_w;
+				msg_config.rows = img_h;
+				ack = 0;
 				e_send_uart1_char((char *)&msg_hdr,
 						sizeof(msg_hdr));
+				ack_time = sched_time();
 				tx_state = TX_CONFIG_ACK;
 			}
 			break;
 		case TX_CONFIG_ACK:
 			/*
-			 * TODO Timeout the wait and reinitialize when timed
-			 * out.
+			 * Without acknowledgment, start again from the
+			 * configuration.
 			 */
 			if ((sel & SEL_SENSING) == 0) {
 				tx_state = TX_INIT;
 			}
-			else if (e_ischar_uart1() && (ack != PMT_ACK)) {
-				e_getchar_uart1((char *)&ack);
-			}
-			else if (!e_uart1_sending() && (ack == PMT_ACK)) {
-				e_send_uart1_char((char *)&msg_config,
-						sizeof(msg_config));
-				tx_state = TX_VISUAL;
+			else {
+				if (!e_uart1_sending() && (ack == PMT_ACK)) {
+					e_send_uart1_char((char *)&msg_config,
+							sizeof(msg_config));
+					ack = 0;
+#if IMG_FORMAT != PPF_GREY
+					/* then the format of the pixels */
+					msg_format.format = IMG_FORMAT;
+					msg_format.bpp = IMG_TX_BPP;
+					msg_hdr.type = PMT_VISUAL_FORMAT;
+					msg_hdr.len = sizeof(msg_format);
+					msg_data = (char *)&msg_format;
+					e_send_uart1_char((char *)&msg_hdr,
+							sizeof(msg_hdr));
+					ack_time = sched_time();
+					tx_state = TX_MSG_ACK;
+#else
+					tx_state = TX_VISUAL;
+#endif	/* IMG_FORMAT */
+				}
+				else if (sched_time() - ack_time
+						>= TX_ACK_TIMEOUT) {
+					tx_state = TX_INIT;
+				}
 			}
 			break;
 		case TX_VISUAL:
 			/*
-			 * Check if a buffer has a new image which has not been
-			 * transmitted yet and start transmission by sending
-			 * the header.
+			 * Take the oldest captured image and start transmission
+			 * by sending the header. A new geometry starts again
+			 * from the configuration.
 			 */
-			if ((sel & SEL_SENSING) == 0) {
+			if (((sel & SEL_SENSING) == 0) || geo_pending) {
 				tx_state = TX_INIT;
 			}
-			else if ((img_bufs[0].data_is_new == 1) && !e_uart1_sending()) {
-				msg_hdr.type = PMT_VISUAL;
-				msg_hdr.len = IMG_DATA_SIZE;
+#if TX_UART2 == 0
+			else if (!e_uart1_sending()
+					&& slot_fits(TX_SHORT_MAX, 0)
+					&& ((msg_data = short_msg(&msg_hdr))
+						!= NULL)) {
+				/* the short messages go first */
+				ack = 0;
 				e_send_uart1_char((char *)&msg_hdr,
 						sizeof(msg_hdr));
-				act_tx_buf = 0;
-				tx_state = TX_VISUAL_ACK;
+				ack_time = sched_time();
+				tx_state = TX_MSG_ACK;
 			}
-			else if ((img_bufs[1].data_is_new == 1) && !e_uart1_sending()) {
-				msg_hdr.type = PMT_VISUAL;
-				msg_hdr.len = IMG_DATA_SIZE;
+#endif	/* TX_UART2 */
+#if TX_MODE == TX_MODE_ROWS
+			else if (!e_uart1_sending()
+					&& ((tx_img = e_poxxxx_pool_stream())
+						!= NULL)) {
+				msg_hdr.type = PMT_VISUAL_ROWS;
+				msg_hdr.len = img_h * (1 + img_tx_row_size);
+				ack = 0;
 				e_send_uart1_char((char *)&msg_hdr,
 						sizeof(msg_hdr));
-				act_tx_buf = 1;
+				ack_time = sched_time();
+				tx_state = TX_VISUAL_ACK;
+			}
+#elif TX_WINDOW > 0
+			else if (!e_uart1_sending() && win_poll()) {
+				/* no acknowledgment to wait for */
+			}
+#else
+			else if (!e_uart1_sending()
+					&& slot_fits(TX_IMG_MAX, 1)
+					&& ((tx_img = take_img()) != NULL)) {
+				tx_data = code_img(tx_img, ref_img, &msg_hdr);
+				slot_count_image();
+				ack = 0;
+#if TX_SWARM == 1
+				tx_marked = send_marked(&msg_hdr, tx_data);
+#endif	/* TX_SWARM */
+				if (!tx_marked)
+					e_send_uart1_char((char *)&msg_hdr,
+							sizeof(msg_hdr));
+				ack_time = sched_time();
 				tx_state = TX_VISUAL_ACK;
 			}
+#endif	/* TX_MODE */
 			break;
 		case TX_VISUAL_ACK:
 			/*
@@ -309,115 +1123,456 @@ int main(void)
 			if ((sel & SEL_SENSING) == 0) {
 				tx_state = TX_INIT;
 			}
-			else if (e_ischar_uart1() && (ack != PMT_ACK)) {
-				e_getchar_uart1((char *)&ack);
+			else {
+#if TX_MODE == TX_MODE_ROWS
+				if (ack == PMT_ACK) {
+					ack = 0;
+					tx_row = 0;
+					tx_state = TX_VISUAL_ROWS;
+				}
+#else
+				if (tx_marked && e_uart1_sending()) {
+					/* the server answers the whole message */
+					ack_time = sched_time();
+				}
+				else if (!e_uart1_sending()
+						&& (ack == PMT_ACK)) {
+					if (!tx_marked)
+						e_send_uart1_char(tx_data,
+								msg_hdr.len);
+					ack = 0;
+					tx_state = TX_VISUAL_SENT;
+				}
+#endif	/* TX_MODE */
+				else if (sched_time() - ack_time
+						>= TX_ACK_TIMEOUT) {
+					tx_state = TX_INIT;
+				}
 			}
-			else if (!e_uart1_sending() && (ack == PMT_ACK)) {
-				e_send_uart1_char(img_bufs[act_tx_buf].data,
-						IMG_DATA_SIZE);
-				ack = 0;
+			break;
+		case TX_VISUAL_ROWS:
+#if TX_MODE == TX_MODE_ROWS
+			/*
+			 * Queue each captured row behind its index, the
+			 * camera goes on with the next rows meanwhile.
+			 */
+			rows = e_poxxxx_pool_rows(tx_img);
+			while ((tx_row < rows) && (tx_row < img_h)
+					&& (e_uart1_tx_free() >= 2)) {
+				struct e_uart_seg segs[2];
+				char *row = tx_img + tx_row * img_row_size;
+
+#if IMG_FORMAT == PPF_RGB332
+				e_img_pack_rgb332(row, img_w);
+#endif	/* IMG_FORMAT */
+				segs[0].buff = (char *)&row_index[tx_row];
+				segs[0].length = 1;
+				segs[1].buff = row;
+				segs[1].length = img_tx_row_size;
+				e_send_uart1_segs(segs, 2);
+				tx_row++;
+			}
+			if (tx_row >= img_h) {
 				tx_state = TX_VISUAL_SENT;
 			}
+#endif	/* TX_MODE */
 			break;
 		case TX_VISUAL_SENT:
 			/*
-			 * Wait until the buffer was sent.
+			 * Wait until the image was sent. It is the reference
+			 * of the next delta, the previous one goes back to
+			 * the camera.
 			 */
 			if (!e_uart1_sending()) {
-				img_bufs[act_tx_buf].data_is_new = 0;
+#if TX_MODE == TX_MODE_DELTA
+				if ((ref_img != NULL) && (ref_img != tx_img))
+					release_img(ref_img);
+				ref_img = tx_img;
+#else
+				release_img(tx_img);
+#endif	/* TX_MODE */
+				tx_img = NULL;
 				tx_state = TX_VISUAL;
 			}
 			break;
+		case TX_MSG_ACK:
+			if ((sel & SEL_SENSING) == 0) {
+				tx_state = TX_INIT;
+			}
+			else {
+				if (!e_uart1_sending() && (ack == PMT_ACK)) {
+					e_send_uart1_char(msg_data,
+							msg_hdr.len);
+					ack = 0;
+					tx_state = TX_VISUAL;
+				}
+				else if (sched_time() - ack_time
+						>= TX_ACK_TIMEOUT) {
+					tx_state = TX_INIT;
+				}
+			}
+			break;
 		}
+	} while (tx_state != prev_state);
+	E_PROF_STATE(&tx_prof, tx_state);
+}
+
+#if TX_UART2 == 1
+/*!
+ * The telemetry state machine on UART2, it runs when bytes are received or
+ * sent on UART2. The short messages are sent here, so that they never wait
+ * behind an image on UART1.
+ */
+static void tel_task(unsigned int events)
+{
+	static int tel_state = TEL_IDLE;
+	static unsigned char ack = 0;
+	static const unsigned char ack_byte = PMT_ACK;
+	static struct puck_msg_hdr msg_hdr;
+	static const char *msg_data;
+	static unsigned int ack_time;	/* when the wait for PMT_ACK began */
+
+	(void)events;
+
+	if (rx_poll(&rx_uart2))
+		ack = PMT_ACK;
+	if (e_uart2_sending())
+		return;
+
+	switch (tel_state) {
+	case TEL_IDLE:
+		if (rx_uart2.ack_pending) {
+			e_send_uart2_char((char *)&ack_byte, 1);
+			rx_uart2.ack_pending = 0;
+		}
+		else if ((sel & SEL_SENSING)
+				&& ((msg_data = short_msg(&msg_hdr)) != NULL)) {
+			ack = 0;
+			e_send_uart2_char((char *)&msg_hdr, sizeof(msg_hdr));
+			ack_time = sched_time();
+			tel_state = TEL_ACK;
+		}
+		break;
+	case TEL_ACK:
+		if (ack == PMT_ACK) {
+			ack = 0;
+			e_send_uart2_char(msg_data, msg_hdr.len);
+			tel_state = TEL_IDLE;
+		}
+		else if (sched_time() - ack_time >= TX_ACK_TIMEOUT) {
+			/* the message is lost, the next one is due soon */
+			tel_state = TEL_IDLE;
+		}
+		break;
+	}
+}
+#endif	/* TX_UART2 */
 #endif	/* DBG_INCLUDE_TRANSMISSION */
 
 #if DBG_INCLUDE_CAM == 1
-		switch (img_state) {
-		case CAM_INACTIVE:
-			if (sel & SEL_SENSING) {
-				img_state = CAM_IDLE;
-			}
-			break;
-		case CAM_IDLE:
-			/* Check if a buffer is free to use and
-			 * start capturing if this is the case */
-			if ((sel & SEL_SENSING) == 0) {
-				img_state = CAM_INACTIVE;
-			}
-			else if (img_bufs[0].data_is_new == 0) {
-				e_poxxxx_launch_capture(img_bufs[0].data);
-				act_img_buf = 0;
-				img_state = CAM_CAPTURING;
-			}
-			else if (img_bufs[1].data_is_new == 0) {
-				e_poxxxx_launch_capture(img_bufs[1].data);
-				act_img_buf = 1;
-				img_state = CAM_CAPTURING;
-			}
+static int cam_state = CAM_INACTIVE;	/*!< State of the camera FSM */
 
-			break;
-		case CAM_CAPTURING:
-			/* Wait until the image is captured and
-			 * mark the buffer as used */
-			if ((sel & SEL_SENSING) == 0) {
-				img_state = CAM_INACTIVE;
-			}
-			else if (e_poxxxx_is_img_ready()) {
-				img_bufs[act_img_buf].data_is_new = 1;
-				img_state = CAM_IDLE;
-			}
-			break;
+/*!
+ * Configures the camera for the area of interest.
+ *
+ * \return	Whether the camera takes the geometry, else its registers are
+ *		left as they were.
+ */
+static int cam_setup(void)
+{
+	if (e_poxxxx_config_cam((ARRAY_WIDTH - (img_w * img_ss))/2,
+			(ARRAY_HEIGHT - (img_h * img_ss))/2, img_w * img_ss,
+			img_h * img_ss, img_ss, img_ss, CAM_MODE) != 0)
+		return 0;
+	e_poxxxx_write_cam_registers();
+	return 1;
+}
+
+/*!
+ * Hands all the image buffers to the frame pool, none is in use.
+ */
+static void cam_pool_init(void)
+{
+	char *bufs[IMG_BUF_COUNT];
+	int i;
+
+	for (i = 0; i < IMG_BUF_COUNT; i++)
+		bufs[i] = img_data[i];
+	e_poxxxx_pool_init(bufs, IMG_BUF_COUNT);
+}
+
+/*!
+ * The camera state machine, it runs when an image is ready. With
+ * DBG_INCLUDE_POWER, the camera is in standby while it is inactive.
+ */
+static void cam_task(unsigned int events)
+{
+	(void)events;
+	switch (cam_state) {
+	case CAM_INACTIVE:
+		if (sel & SEL_SENSING) {
+#if DBG_INCLUDE_POWER == 1
+			e_poxxxx_wake_cam();
+			cam_setup();
+#endif	/* DBG_INCLUDE_POWER */
+			e_poxxxx_pool_start();
+			cam_state = CAM_ACTIVE;
 		}
-#else	/* Real CAM is disabled, so here is a dummy */
+		break;
+	case CAM_ACTIVE:
 		/*
-		 * Camera is not included, so generate a fixed image.
+		 * The pool launches the next capture as soon as the
+		 * camera is idle and a buffer is free.
 		 */
-		switch (img_state) {
-		case CAM_INACTIVE:
-			if (sel & SEL_SENSING) {
-				img_state = CAM_IDLE;
-			}
-			break;
-		case CAM_IDLE:
-			/* Check if a buffer is free to use and
-			 * start capturing if this is the case */
-			if ((sel & SEL_SENSING) == 0) {
-				img_state = CAM_INACTIVE;
-			}
-			else if (buf[0].data_is_new == 0) {
-				for (i = 0; i < IMG_DATA_SIZE; i++)
-					buf[0].data[i] = i;
-				act_img_buf = 0;
-				img_state = CAM_CAPTURING;
-			}
-			else if (buf[1].data_is_new == 0) {
-				for (i = 0; i < IMG_DATA_SIZE; i++)
-					buf[1].data[i] = i;
-				act_img_buf = 1;
-				img_state = CAM_CAPTURING;
-			}
-			break;
-		case CAM_CAPTURING:
-			/* Wait until the image is captured and
-			 * mark the buffer as used */
-			if ((sel & SEL_SENSING) == 0) {
-				img_state = CAM_INACTIVE;
-			}
-			else {
-				buf[act_img_buf].data_is_new = 1;
-				img_state = CAM_IDLE;
-			}
-			break;
+		if ((sel & SEL_SENSING) == 0) {
+			e_poxxxx_pool_stop();
+#if DBG_INCLUDE_POWER == 1
+			cam_state = CAM_STOPPING;
+#else
+			cam_state = CAM_INACTIVE;
+#endif	/* DBG_INCLUDE_POWER */
+		}
+		else {
+			e_poxxxx_pool_update();
 		}
+		break;
+	case CAM_STOPPING:
+		if (sel & SEL_SENSING) {
+			e_poxxxx_pool_start();
+			cam_state = CAM_ACTIVE;
+		}
+		else if (!e_poxxxx_pool_capturing()) {
+			e_poxxxx_sleep_cam();
+			cam_state = CAM_INACTIVE;
+		}
+		break;
+	}
+}
 #endif	/* DBG_INCLUDE_CAM */
 
+#if DBG_INCLUDE_CAM == 1
+/*!
+ * Gives the parameters of the geometry back the values in effect, after the
+ * camera refused the new ones. Their answers tell the server.
+ */
+static void geo_refuse(unsigned int w, unsigned int h, unsigned int ss)
+{
+	static const unsigned int ids[3] = {PP_IMG_W, PP_IMG_H, PP_IMG_SS};
+	const unsigned int old[3] = {w, h, ss};
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		if (params_get(ids[i]) == (int)old[i])
+			continue;
+		params_revert(ids[i], old[i]);
+		param_refused |= 1 << ids[i];
+		param_due |= 1 << ids[i];
+	}
+	geo_read();
+}
+#endif	/* DBG_INCLUDE_CAM */
 
-		/*
-		 * Short waiting period to give the motors and sensors time to
-		 * react.
-		 */
-		myWait(100);
+/*!
+ * Configures the camera for the geometry of the parameters. The images
+ * captured before are dropped, none may be in use. If the camera refuses
+ * the geometry, the one in effect stays. A save that waited is done then.
+ *
+ * \return	Whether it is done, 0 while the last capture goes on.
+ */
+static int geo_apply(void)
+{
+#if DBG_INCLUDE_CAM == 1
+	unsigned int w = img_w, h = img_h, ss = img_ss;
+
+	e_poxxxx_pool_stop();
+	if (e_poxxxx_pool_capturing())
+		return 0;
+#if DBG_INCLUDE_POWER == 1
+	/* in standby, it is woken up to check the geometry */
+	if (cam_state == CAM_INACTIVE)
+		e_poxxxx_wake_cam();
+#endif	/* DBG_INCLUDE_POWER */
+	geo_read();
+	if (!cam_setup()) {
+		geo_refuse(w, h, ss);
+		cam_setup();
+	}
+#if DBG_INCLUDE_POWER == 1
+	if (cam_state == CAM_INACTIVE)
+		e_poxxxx_sleep_cam();
+#endif	/* DBG_INCLUDE_POWER */
+	cam_pool_init();
+	if (cam_state == CAM_ACTIVE)
+		e_poxxxx_pool_start();
+#else
+	geo_read();
+#endif	/* DBG_INCLUDE_CAM */
+#if IMG_POLICY == 1
+	img_policy_init();
+#endif	/* IMG_POLICY */
+	if (param_save_due) {
+		params_save();
+		param_save_due = 0;
+	}
+	return 1;
+}
+
+#if DBG_INCLUDE_POWER == 1
+/*!
+ * Puts the core to sleep in selector position 0, once the other FSMs are
+ * done and nothing was received for POWER_AWAKE_TIME.
+ */
+static void power_task(unsigned int events)
+{
+	static unsigned int awake = 0;	/* Time of the last activity */
+
+	if ((sel != 0) || (events & (EV_RX | EV_RX2))) {
+		awake = sched_time();
+		return;
 	}
+	if (sched_time() - awake < POWER_AWAKE_TIME)
+		return;
+#if DBG_INCLUDE_MOTION == 1
+	if (e_motors_running())
+		return;
+#endif	/* DBG_INCLUDE_MOTION */
+#if DBG_INCLUDE_CAM == 1
+	if (cam_state != CAM_INACTIVE)
+		return;
+#endif	/* DBG_INCLUDE_CAM */
+#if DBG_INCLUDE_TRANSMISSION == 1
+	if (e_uart1_sending())
+		return;
+#if TX_UART2 == 1
+	if (e_uart2_sending())
+		return;
+#endif	/* TX_UART2 */
+#endif	/* DBG_INCLUDE_TRANSMISSION */
+	power_sleep();
+	awake = sched_time();
+}
+#endif	/* DBG_INCLUDE_POWER */
+
+/*!
+ * The tasks, in the order they run when their events fire together.
+ */
+static struct sched_task tasks[] = {
+	{sel_task, 0, SEL_PERIOD, 0},
+#if DBG_INCLUDE_PROXIMITY == 1
+	{prox_task, EV_PROX, TASK_PERIOD, 0},
+#endif	/* DBG_INCLUDE_PROXIMITY */
+#if DBG_INCLUDE_ODOMETRY == 1
+	{odo_task, 0, ODO_PERIOD, 0},
+#endif	/* DBG_INCLUDE_ODOMETRY */
+#if DBG_INCLUDE_BEARING == 1
+	{bearing_task, 0, BEARING_PERIOD, 0},
+#endif	/* DBG_INCLUDE_BEARING */
+#if DBG_INCLUDE_MOTION == 1
+	{motion_task, EV_PROX, TASK_PERIOD, 0},
+#endif	/* DBG_INCLUDE_MOTION */
+#if DBG_INCLUDE_CAM == 1
+	{cam_task, EV_IMG, TASK_PERIOD, 0},
+#endif	/* DBG_INCLUDE_CAM */
+#if DBG_INCLUDE_TRANSMISSION == 1
+	{tx_task, EV_RX | EV_TX | EV_IMG | EV_ROW, TX_PERIOD, 0},
+#if TX_UART2 == 1
+	{tel_task, EV_RX2 | EV_TX2, TEL_PERIOD, 0},
+#endif	/* TX_UART2 */
+#endif	/* DBG_INCLUDE_TRANSMISSION */
+#if DBG_INCLUDE_POWER == 1
+	{power_task, EV_RX | EV_RX2, SEL_PERIOD, 0},
+#endif	/* DBG_INCLUDE_POWER */
+};
+
+int main(void)
+{
+#if TX_MODE == TX_MODE_ROWS
+	int i;
+#endif	/* TX_MODE */
+
+	/* Initialization */
+	e_init_port();
+	params_load();
+	geo_read();
+#if DBG_INCLUDE_PROFILE == 1
+	e_prof_init();
+#endif	/* DBG_INCLUDE_PROFILE */
+#if DBG_INCLUDE_PROXIMITY == 1
+	e_init_prox();
+	e_ad_set_prox_schedule(0x0F, PROX_PULSE_SCANS, PROX_GAP_SCANS);
+	e_set_led_dim(PROX_LED_LEVEL);
+#endif	/* DBG_INCLUDE_PROXIMITY */
+#if DBG_INCLUDE_MOTION == 1
+	e_init_motors();
+	e_set_acceleration(params_get(PP_MOTION_ACCEL));
+	nav_set_speed(params_get(PP_MOVING_SPEED));
+#endif	/* DBG_INCLUDE_MOTION */
+#if DBG_INCLUDE_ODOMETRY == 1
+	odo_init();
+#endif	/* DBG_INCLUDE_ODOMETRY */
+#if DBG_INCLUDE_BEARING == 1
+	bearing_init();
+#endif	/* DBG_INCLUDE_BEARING */
+#if DBG_INCLUDE_TRANSMISSION == 1
+	e_init_uart1();
+#if IMG_POLICY == 1
+	img_policy_init();
+#endif	/* IMG_POLICY */
+#if TX_UART2 == 1
+	e_init_uart2();
+#endif	/* TX_UART2 */
+#endif	/* DBG_INCLUDE_TRANSMISSION */
+#if DBG_INCLUDE_CAM == 1
+	e_poxxxx_init_cam();
+	cam_setup();
+	cam_pool_init();
+#if DBG_INCLUDE_POWER == 1
+	/* until the sensing is selected */
+	e_poxxxx_sleep_cam();
+#endif	/* DBG_INCLUDE_POWER */
+#endif	/* DBG_INCLUDE_CAM */
+#if DBG_INCLUDE_POWER == 1
+	power_init();
+#endif	/* DBG_INCLUDE_POWER */
+	/* the priorities set by the drivers are replaced by the table */
+	irq_init();
+	/* the tick runs from here on, myWait() counts it */
+	sched_init();
+#if TX_MODE == TX_MODE_ROWS
+	for (i = 0; i < IMG_H; i++)
+		row_index[i] = i;
+#endif	/* TX_MODE */
+
+	/* Safety wait period to prevent UART clogging */
+	myWait(500);
+
+#if DBG_BENCHMARK == 1
+	sel = SEL_SENSING;
+#else
+	/* Selector in position 0 lets the e-Puck wait at the start. */
+	do {
+		sel = get_selector();
+#if DBG_INCLUDE_POWER == 1
+		if (sel == 0)
+			power_sleep();
+#endif	/* DBG_INCLUDE_POWER */
+		myWait(500);
+	} while (sel == 0);
+#endif	/* DBG_BENCHMARK */
+
+#if DBG_INCLUDE_PROXIMITY == 1
+	/* The puck is placed by now, away from obstacles. */
+	if (PROX_CALIBRATE || !e_prox_load_calibration()) {
+		e_calibrate_prox();
+		e_prox_save_calibration();
+	}
+#endif	/* DBG_INCLUDE_PROXIMITY */
+
+	/*
+	 * The tasks run when their events fire, e.g. the motion reacts to each
+	 * proximity cycle (5.7 ms), and the core idles in between.
+	 */
+	sched_run(tasks, sizeof(tasks) / sizeof(tasks[0]));
 
 	return 0;
 }
@@ -425,4 +1580,3 @@ int main(void)
 /*!
  * @}
  */
-
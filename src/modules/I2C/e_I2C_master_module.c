@@ -35,9 +35,11 @@ EPFL Ecole polytechnique federale de Lausanne http://www.epfl.ch
  */
 
 #include "e_I2C_master_module.h"
+#include "../profile/e_profile.h"
 
 char e_i2c_mode;
 int  e_interrupts[3];
+void (*e_i2c_handler)(void) = 0;	// set by e_I2C_queue.c while it runs
 
 /*! \brief Wait until I2C Bus is Inactive */
 void idle_i2c(void)
@@ -267,6 +269,12 @@ char e_i2c_write(char byte)
 // interrupt  routine: 
 void  __attribute__((__interrupt__, auto_psv)) _MI2CInterrupt(void)
 {
+	E_PROF_ENTER();
+
 	IFS0bits.MI2CIF=0;			// clear master interrupt flag
-	e_i2c_mode=OPERATION_OK;	
+	if(e_i2c_handler)
+		e_i2c_handler();		// a queued transaction is running
+	else
+		e_i2c_mode=OPERATION_OK;	
+	E_PROF_EXIT(E_PROF_MI2C);
 }
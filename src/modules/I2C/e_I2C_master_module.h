@@ -194,5 +194,8 @@ char e_i2c_enable(void);
 char e_i2c_disable(void);
 char e_i2c_reset(void);
 
+// if set, called by the MI2C interrupt instead of the blocking functions
+extern void (*e_i2c_handler)(void);
+
 
 #endif
@@ -38,10 +38,14 @@ void e_i2cp_init(void)
 }
 
 /*! \brief Enable special I2C interrupt
+ *
+ * Waits first for the end of the queued transactions, they use the same
+ * interrupt.
  * \return 1 to confirme the oparation and 0 for an error
  */
 void e_i2cp_enable(void)
 {
+	e_i2cq_flush();
 	e_i2c_enable();
 }
 
@@ -56,13 +60,14 @@ void e_i2cp_disable(void)
 /*! \brief Read a specific register on a device
  * \param device_add The address of the device you want information
  * \param reg The register address you want read on the device
- * \return The readed value
+ * \return The readed value, 0 if the device didn't answer
  */
 char e_i2cp_read(char device_add, char reg)
 {
 	char error=0;
-	char value;
-	while(!error)
+	char value=0;
+	int tries;
+	for(tries=0;!error && tries<I2CP_TRIES;tries++)
 	{
 		error=1;
 		error&=e_i2c_start();
@@ -123,8 +128,9 @@ char e_i2cp_read_string(char device_add, unsigned char read_buffer[], char start
 char e_i2cp_write (char device_add, char reg, char value)
 {
 	char error=0;
+	int tries;
 
-	while(!error)
+	for(tries=0;!error && tries<I2CP_TRIES;tries++)
 	{
 		error=1;
 		error&=e_i2c_start();
@@ -139,14 +145,22 @@ char e_i2cp_write (char device_add, char reg, char value)
 	return error;
 }
 
-//BOF: ne marche surement pas
-/*
+/*! \brief Write consecutive registers on a device
+ *
+ * The registers are written in one burst, the device must increment the
+ * register address after each byte.
+ * \param device_add The address of the device
+ * \param write_buffer The data you want to write
+ * \param start_address The first register address
+ * \param string_length The number of registers to write
+ * \return 1 to confirme the oparation and 0 for an error
+ */
 char e_i2cp_write_string (char device_add, unsigned char write_buffer[], char start_address, char string_length)
 {
 	char error=0;
-	int i = 0;
+	int i, tries;
 
-	while(!error)
+	for(tries=0;!error && tries<I2CP_TRIES;tries++)
 	{
 		error=1;
 		error&=e_i2c_start();
@@ -157,8 +171,7 @@ char e_i2cp_write_string (char device_add, unsigned char write_buffer[], char st
 		error&=e_i2c_stop();             // Ending the communication	
 		if(error)
 			break;
-//		e_i2c_reset();
+		e_i2c_reset();
 	}
 	return error;
 }
-*/
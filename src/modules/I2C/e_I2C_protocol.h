@@ -31,6 +31,7 @@ EPFL Ecole polytechnique federale de Lausanne http://www.epfl.ch
 #define _I2C_PROTOCOL
 
 #include "e_I2C_master_module.h"
+#include "e_I2C_queue.h"
 #include "../motor_led/e_epuck_ports.h"
 
 
@@ -39,6 +40,10 @@ EPFL Ecole polytechnique federale de Lausanne http://www.epfl.ch
 // use void e_i2cp_init(void); in your initialisation. no interrupt is enable
 // use void e_i2cp_enable(void); before any other operation to enable the interrupts
 // use e_i2cp_write,I2Cp_read to write or read in the Camera registers
+// they give up after I2CP_TRIES failed tries instead of looping forever
+// use e_i2cq_submit to queue transactions without waiting (e_I2C_queue.h)
+
+#define I2CP_TRIES	10
 
 void e_i2cp_init(void);
 char e_i2cp_write (char device_add,char reg, char value);
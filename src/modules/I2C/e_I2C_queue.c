@@ -0,0 +1,244 @@
+/*! \file
+ * \ingroup i2c
+ * \brief Queue of I2C transactions run by the master interrupt.
+ *
+ * The MI2C interrupt fires at the end of each bus event (start, byte,
+ * restart, acknowledge, stop), the handler then starts the next one. Between
+ * two transactions the handler is removed and the interrupt disabled, so the
+ * blocking functions of e_I2C_protocol.c work as before.
+ * \author Code: Darius Kellermann
+ */
+
+#include <stddef.h>
+
+#include "e_I2C_master_module.h"
+#include "e_I2C_queue.h"
+
+#define Q_IDLE		0	/* no transaction running */
+#define Q_START		1	/* start bit sent */
+#define Q_ADDR		2	/* device address sent */
+#define Q_REG		3	/* register address sent */
+#define Q_WRITE		4	/* data byte sent */
+#define Q_RESTART	5	/* restart bit sent */
+#define Q_RADDR		6	/* device address sent for reading */
+#define Q_READ		7	/* data byte received */
+#define Q_ACK		8	/* acknowledge sent */
+#define Q_STOP		9	/* stop bit sent */
+
+static struct e_i2cq_trans *head = NULL;	// running transaction
+static struct e_i2cq_trans *tail = NULL;
+static volatile int state = Q_IDLE;
+
+static unsigned char *buf;	// bytes of the current burst
+static unsigned char reg;	// first register of the current burst
+static unsigned char len;	// length of the current burst
+static unsigned char n;		// bytes of the burst already done
+static unsigned char pair;	// current pair, with E_I2CQ_PAIRS
+static unsigned char tries;	// tries of the current burst
+static unsigned char error;	// the current try failed
+
+static void handler(void);
+
+/* start the current burst of head */
+static void begin_burst(void)
+{
+	if (head->flags & E_I2CQ_PAIRS) {
+		reg = head->data[2 * pair];
+		buf = &head->data[2 * pair + 1];
+		len = 1;
+	} else {
+		reg = head->reg;
+		buf = head->data;
+		len = head->length;
+	}
+	n = 0;
+	error = 0;
+	state = Q_START;
+	I2CCONbits.SEN = 1;
+}
+
+/* start head, or stop the engine if the queue is empty */
+static void begin(void)
+{
+	if (head == NULL) {
+		state = Q_IDLE;
+		e_i2c_handler = NULL;
+		IEC0bits.MI2CIE = 0;
+		return;
+	}
+	pair = 0;
+	tries = 0;
+	e_i2c_handler = handler;
+	IFS0bits.MI2CIF = 0;
+	IEC0bits.MI2CIE = 1;
+	begin_burst();
+}
+
+/* end head with the given status and go on with the next one */
+static void complete(int status)
+{
+	struct e_i2cq_trans *t = head;
+
+	head = t->next;
+	if (head == NULL)
+		tail = NULL;
+	state = Q_IDLE;
+	t->status = status;
+	if (t->done != NULL)
+		t->done(t);
+	// the callback may have started the next one with e_i2cq_submit
+	if (state == Q_IDLE)
+		begin();
+}
+
+/* called once the bus is free after a burst */
+static void end_burst(void)
+{
+	if (error) {
+		if (++tries < E_I2CQ_TRIES)
+			begin_burst();
+		else
+			complete(E_I2CQ_FAILED);
+		return;
+	}
+	tries = 0;
+	if ((head->flags & E_I2CQ_PAIRS) && ++pair < head->length)
+		begin_burst();
+	else
+		complete(E_I2CQ_DONE);
+}
+
+static void stop(void)
+{
+	state = Q_STOP;
+	I2CCONbits.PEN = 1;
+}
+
+static void fail(void)
+{
+	error = 1;
+	stop();
+}
+
+static void handler(void)
+{
+	if (I2CSTATbits.BCL) {
+		// the module gave up the bus, there is no stop to send
+		I2CSTATbits.BCL = 0;
+		error = 1;
+		end_burst();
+		return;
+	}
+
+	switch (state) {
+	case Q_START:
+		I2CTRN = head->device;
+		state = Q_ADDR;
+		break;
+	case Q_ADDR:
+		if (I2CSTATbits.ACKSTAT) {
+			fail();
+			break;
+		}
+		I2CTRN = reg;
+		state = Q_REG;
+		break;
+	case Q_REG:
+		if (I2CSTATbits.ACKSTAT) {
+			fail();
+			break;
+		}
+		if (head->flags & E_I2CQ_READ) {
+			I2CCONbits.RSEN = 1;
+			state = Q_RESTART;
+			break;
+		}
+		// no break, the first byte is written like the next ones
+	case Q_WRITE:
+		if ((state == Q_WRITE) && I2CSTATbits.ACKSTAT) {
+			fail();
+			break;
+		}
+		if (n < len) {
+			I2CTRN = buf[n++];
+			state = Q_WRITE;
+		} else
+			stop();
+		break;
+	case Q_RESTART:
+		I2CTRN = head->device | 1;
+		state = Q_RADDR;
+		break;
+	case Q_RADDR:
+		if (I2CSTATbits.ACKSTAT) {
+			fail();
+			break;
+		}
+		I2CCONbits.RCEN = 1;
+		state = Q_READ;
+		break;
+	case Q_READ:
+		buf[n++] = I2CRCV;
+		I2CCONbits.ACKDT = (n >= len);	// nack the last byte
+		I2CCONbits.ACKEN = 1;
+		state = Q_ACK;
+		break;
+	case Q_ACK:
+		if (n < len) {
+			I2CCONbits.RCEN = 1;
+			state = Q_READ;
+		} else
+			stop();
+		break;
+	case Q_STOP:
+		end_burst();
+		break;
+	}
+}
+
+/*! \brief Queue a transaction
+ *
+ * The transaction starts at once if the bus is idle. It can be called from
+ * a callback to chain transactions.
+ * \param t The transaction, its status is set to \ref E_I2CQ_PENDING
+ */
+void e_i2cq_submit(struct e_i2cq_trans *t)
+{
+	unsigned int ipl = SRbits.IPL;
+
+	t->next = NULL;
+	t->status = E_I2CQ_PENDING;
+	if (t->length == 0) {
+		t->status = E_I2CQ_DONE;
+		if (t->done != NULL)
+			t->done(t);
+		return;
+	}
+
+	// keep the handler out, but not the camera interrupts above it
+	if (ipl < IPC3bits.MI2CIP)
+		SRbits.IPL = IPC3bits.MI2CIP;
+	if (tail != NULL)
+		tail->next = t;
+	else
+		head = t;
+	tail = t;
+	if (state == Q_IDLE)
+		begin();
+	SRbits.IPL = ipl;
+}
+
+/*! \brief Check if transactions are queued or running
+ * \return Non-zero if the queue is busy
+ */
+int e_i2cq_busy(void)
+{
+	return (state != Q_IDLE) || (head != NULL);
+}
+
+/*! \brief Wait until all the queued transactions are over */
+void e_i2cq_flush(void)
+{
+	while (e_i2cq_busy())
+		;
+}
@@ -0,0 +1,58 @@
+/*! \file
+ * \ingroup i2c
+ * \brief Queue of I2C transactions run by the master interrupt.
+ *
+ * A transaction reads or writes a burst of registers of a device, or a list
+ * of (register, value) pairs. They are queued with \ref e_i2cq_submit and
+ * run one after the other by the MI2C interrupt, so the caller goes on while
+ * the bytes are on the bus. When a transaction is over, its status is set
+ * and its callback is called.
+ *
+ * A transaction that is not acknowledged, or that loses the bus, is tried
+ * again from its current burst, at most \ref E_I2CQ_TRIES times.
+ *
+ * \warning The transactions are owned by the caller and must stay valid
+ * until they are over. The callbacks run in the MI2C interrupt.
+ * \author Code: Darius Kellermann
+ */
+
+#ifndef _I2C_QUEUE
+#define _I2C_QUEUE
+
+/*! Number of tries of a burst before the transaction fails */
+#define E_I2CQ_TRIES		3
+
+/* Flags of a transaction */
+#define E_I2CQ_WRITE		0	/*!< Write from the first register on */
+#define E_I2CQ_READ		1	/*!< Read from the first register on */
+#define E_I2CQ_PAIRS		2	/*!< data holds (register, value) pairs */
+
+/* Status of a transaction */
+#define E_I2CQ_PENDING		0	/*!< Queued or running */
+#define E_I2CQ_DONE		1	/*!< Over, all the bytes went through */
+#define E_I2CQ_FAILED		-1	/*!< Over, a burst failed every try */
+
+/*! \brief An I2C transaction
+ *
+ * With \ref E_I2CQ_PAIRS, each pair is a burst of one byte: data[2i] is the
+ * register and data[2i + 1] the value, written or read, and length counts
+ * the pairs.
+ */
+struct e_i2cq_trans {
+	unsigned char device;		/*!< Device address, bit 0 cleared */
+	unsigned char reg;		/*!< First register, without PAIRS */
+	unsigned char flags;		/*!< E_I2CQ_READ, E_I2CQ_PAIRS */
+	unsigned char length;		/*!< Number of bytes or pairs */
+	unsigned char *data;		/*!< The bytes to write or read */
+	void (*done)(struct e_i2cq_trans *t);	/*!< Callback, or NULL */
+	volatile int status;		/*!< E_I2CQ_PENDING, _DONE, _FAILED */
+	struct e_i2cq_trans *next;	/*!< Used by the queue */
+};
+
+void e_i2cq_submit(struct e_i2cq_trans *t);
+
+int e_i2cq_busy(void);
+
+void e_i2cq_flush(void);
+
+#endif
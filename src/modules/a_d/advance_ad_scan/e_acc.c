@@ -0,0 +1,41 @@
+/*! \file
+ * \ingroup a_d
+ * \brief Accessing the accelerometer sensor data (ADC interrupt scan).
+ * \author Code: Darius Kellermann
+ */
+
+#include "e_ad_conv.h"
+#include "e_acc.h"
+
+/*! \brief Init the ADC scan
+ * \warning Must be called before starting using accelerometer. If the
+ * proximity sensors are already initialized, this is not needed.
+ */
+void e_init_acc(void)
+{
+	e_init_ad_scan();
+}
+
+/*! \brief To get the analogic x, y, z axis accelerations
+ *
+ * The values are the mean of the last \ref ACC_SAMP_NB samples (about
+ * 2 ms). The proximity sensors keep running, use \ref e_ad_get_acc_sample
+ * to get a single timestamped sample.
+ * \param x A pointer to store the analogic x acceleration
+ * \param y A pointer to store the analogic y acceleration
+ * \param z A pointer to store the analogic z acceleration
+ */
+void e_get_acc(int *x, int *y, int *z)
+{
+	long sum[3] = {0, 0, 0};
+	unsigned int i;
+
+	for (i = 0; i < ACC_SAMP_NB; i++) {
+		sum[0] += e_acc_scan[0][i];
+		sum[1] += e_acc_scan[1][i];
+		sum[2] += e_acc_scan[2][i];
+	}
+	*x = sum[0] / ACC_SAMP_NB;
+	*y = sum[1] / ACC_SAMP_NB;
+	*z = sum[2] / ACC_SAMP_NB;
+}
@@ -0,0 +1,18 @@
+/*! \file
+ * \ingroup a_d
+ * \brief Accessing the accelerometer sensor data (ADC interrupt scan).
+ *
+ * Same interface as a_d/e_accelerometer.h. The samples are acquired by the
+ * ADC interrupt (see e_ad_conv.h), the last \ref ACC_SAMP_NB samples of each
+ * axis are available in \ref e_acc_scan.
+ * \author Code: Darius Kellermann
+ */
+
+#ifndef _ACCELEROMETER_SCAN
+#define _ACCELEROMETER_SCAN
+
+/* functions */
+void e_init_acc(void);   // to be called before starting using accelerometer
+void e_get_acc(int *x, int *y, int *z); // to get analog value of accelerometer
+
+#endif
@@ -0,0 +1,479 @@
+/*! \file
+ * \ingroup a_d
+ * \brief Module for the Analogic/Digital conversion (ADC interrupt scan).
+ *
+ * The ADC scans MIC1..MIC3, ACCX..ACCZ and one pair of IR sensors in its
+ * auto-sample/auto-convert mode and raises an interrupt every
+ * \ref AD_SCAN_CHANNELS conversions. The interrupt routine stores the
+ * results and sequences the IR LED pulses, so no conversion is ever waited
+ * for at interrupt priority.
+ *
+ * The sequence of the scans is given by \ref ad_slot_table, which is built
+ * from the pairs and timings set by \ref e_ad_set_prox_schedule and
+ * \ref e_ad_set_prox_wait. This module is
+ * the only owner of the ADC, the other modules of this package only read
+ * the samples it stores.
+ * \author Code: Darius Kellermann
+ */
+
+#include <stddef.h>
+
+#include "../../motor_led/e_epuck_ports.h"
+#include "e_ad_conv.h"
+#include "../../profile/e_profile.h"
+
+/* channels always scanned: MIC1..MIC3 (AN2..AN4) and ACCX..ACCZ (AN5..AN7) */
+#define AD_SSL_BASE	0x00FC
+/* channels of the IR pair n: IRn (AN8+n) and IRn+4 (AN12+n) */
+#define AD_SSL_IR(n)	((1 << (IR0 + (n))) | (1 << (IR4 + (n))))
+
+/* actions done at the end of a slot */
+#define AD_SLOT_AMBIENT		0	/* latch ambient light, IR LEDs on */
+#define AD_SLOT_REFLECTED	1	/* latch reflected light, IR LEDs off */
+#define AD_SLOT_WAIT		2	/* nothing, the IR LEDs stay off */
+
+#define AD_SLOT_MAX	9	/* two slots per pair and the wait */
+
+/*! One slot of the ADC schedule */
+struct ad_slot {
+	unsigned int ssl;	/*!< ADCSSL during the slot (8 channels) */
+	unsigned int scans;	/*!< Length of the slot, in scans */
+	unsigned char pair;	/*!< IR pair converted during the slot */
+	unsigned char action;	/*!< Action at the end of the slot */
+};
+
+/*! The schedule of one proximity cycle (about 10 ms by default).
+ *
+ * The microphones and the accelerometer are part of every slot, so they are
+ * sampled at the scan rate whatever the proximity sensors do. Every ADCSSL
+ * value must select exactly \ref AD_SCAN_CHANNELS inputs.
+ */
+static struct ad_slot ad_slot_table[AD_SLOT_MAX];
+static unsigned int ad_slot_nb = 0;
+
+static unsigned int prox_pairs = 0x0F;		// pairs in the schedule
+static unsigned int prox_pulse = AD_IR_PULSE_SCANS;	// scans with LEDs on
+static unsigned int prox_gap = AD_IR_PAIR_SCANS - AD_IR_PULSE_SCANS;
+static unsigned int prox_wait = 0;		// scans at the end of a cycle
+static void (*prox_callback)(void) = NULL;	// called after each cycle
+
+static int *mic_blocks = NULL;		// two blocks, NULL if no capture
+static unsigned int mic_block_size = 0;	// ints per block, 3 per scan
+static unsigned int mic_block_pos = 0;	// next int to write, both blocks
+
+int e_mic_scan[3][MIC_SAMP_NB];		// microphone samples
+int e_acc_scan[3][ACC_SAMP_NB];		// accelerometer samples
+unsigned int e_last_mic_scan_id = 0;	// last written microphone sample
+unsigned int e_last_acc_scan_id = 0;	// last written accelerometer sample
+
+int e_ambient_ir[8];			// ambient light measurement
+int e_ambient_and_reflected_ir[8];	// light when led is on
+int e_reflected_ir[8];			// variation of light
+int e_prox_offset[8];			// reflected light without obstacle
+int e_prox_filtered[8];			// calibrated and filtered reflected light
+
+volatile unsigned long e_ad_scan_count = 0;	// scans since the start
+volatile unsigned int e_mic_block_count = 0;	// complete microphone blocks
+volatile unsigned int e_ad_prox_cycle = 0;	// complete proximity cycles
+
+static unsigned int slot = 0;		// current slot of the table
+static unsigned int slot_scan = 0;	// scans done in the current slot
+static int running = 0;			// the ADC is initialized and scanning
+
+static int prox_past[8][2];		// last two calibrated values
+static unsigned int prox_ema[8];	// filter state, AD_PROX_FILTER more bits
+
+/* internal calls */
+
+/* fill ad_slot_table from the prox_ settings */
+static void build_schedule(void)
+{
+	struct ad_slot *s = ad_slot_table;
+	unsigned int pair;
+
+	for (pair = 0; pair < 4; pair++)
+	{
+		if ((prox_pairs & (1 << pair)) == 0)
+			continue;
+		s->ssl = AD_SSL_BASE | AD_SSL_IR(pair);
+		s->scans = prox_gap;
+		s->pair = pair;
+		s->action = AD_SLOT_AMBIENT;
+		s++;
+		s->ssl = AD_SSL_BASE | AD_SSL_IR(pair);
+		s->scans = prox_pulse;
+		s->pair = pair;
+		s->action = AD_SLOT_REFLECTED;
+		s++;
+	}
+	if ((prox_wait > 0) || (s == ad_slot_table))
+	{
+		s->ssl = AD_SSL_BASE | AD_SSL_IR(0);
+		s->scans = (prox_wait > 0) ? prox_wait : prox_gap;
+		s->pair = 0;
+		s->action = AD_SLOT_WAIT;
+		s++;
+	}
+	ad_slot_nb = s - ad_slot_table;
+}
+
+/* install a new schedule, from the start of a cycle */
+static void apply_schedule(void)
+{
+	unsigned int ie = IEC0bits.ADIE;
+
+	IEC0bits.ADIE = 0;
+	PULSE_IR0 = PULSE_IR1 = PULSE_IR2 = PULSE_IR3 = 0;
+	build_schedule();
+	slot = 0;
+	slot_scan = 0;
+	ADCSSL = ad_slot_table[0].ssl;
+	IEC0bits.ADIE = ie;
+}
+
+static void ir_pulse(unsigned int pair, unsigned int value)
+{
+	switch (pair)
+	{
+		case 0: PULSE_IR0 = value; break;	// ir sensors 0 and 4
+		case 1: PULSE_IR1 = value; break;	// ir sensors 1 and 5
+		case 2: PULSE_IR2 = value; break;	// ir sensors 2 and 6
+		case 3: PULSE_IR3 = value; break;	// ir sensors 3 and 7
+	}
+}
+
+/* calibrate and filter the last reflected value of a sensor */
+static void prox_filter(unsigned int i)
+{
+	int v = e_reflected_ir[i] - e_prox_offset[i];
+	int a = prox_past[i][0], b = prox_past[i][1], m;
+
+	if (v < 0)
+		v = 0;
+	prox_past[i][1] = a;
+	prox_past[i][0] = v;
+
+	// median of v, a and b
+	if (a > b)
+	{
+		m = a;
+		a = b;
+		b = m;
+	}
+	m = (v < a) ? a : (v > b) ? b : v;
+
+	prox_ema[i] += m - (prox_ema[i] >> AD_PROX_FILTER);
+	e_prox_filtered[i] = prox_ema[i] >> AD_PROX_FILTER;
+}
+
+/* the last scan of a slot is done, latch its IR pair and go to the next */
+static void end_slot(const struct ad_slot *cur)
+{
+	unsigned int pair;
+
+	pair = cur->pair;
+	if (cur->action == AD_SLOT_AMBIENT)
+	{
+		e_ambient_ir[pair] = ADCBUF6;
+		e_ambient_ir[pair + 4] = ADCBUF7;
+		ir_pulse(pair, 1);		// led on for next measurement
+	}
+	else if (cur->action == AD_SLOT_REFLECTED)
+	{
+		e_ambient_and_reflected_ir[pair] = ADCBUF6;
+		e_ambient_and_reflected_ir[pair + 4] = ADCBUF7;
+		e_reflected_ir[pair] = e_ambient_ir[pair] -
+				e_ambient_and_reflected_ir[pair];
+		e_reflected_ir[pair + 4] = e_ambient_ir[pair + 4] -
+				e_ambient_and_reflected_ir[pair + 4];
+		ir_pulse(pair, 0);		// led off
+		prox_filter(pair);
+		prox_filter(pair + 4);
+	}
+
+	slot_scan = 0;
+	if (++slot >= ad_slot_nb)
+	{
+		slot = 0;
+		e_ad_prox_cycle++;
+		if (prox_callback != NULL)
+			prox_callback();
+	}
+	if (ad_slot_table[slot].ssl != cur->ssl)
+		ADCSSL = ad_slot_table[slot].ssl;
+}
+
+/*! \brief The ADC interrupt.
+ *
+ * Called after every scan of \ref AD_SCAN_CHANNELS channels. The IR samples
+ * are only used at the end of a slot: right before the LEDs are switched on
+ * (ambient light) and \ref AD_IR_PULSE_SCANS scans later (ambient and
+ * reflected light).
+ */
+void __attribute__((interrupt, auto_psv))
+_ADCInterrupt(void)
+{
+	const struct ad_slot *cur;
+	unsigned int id;
+	E_PROF_ENTER();
+
+	IFS0bits.ADIF = 0;		// clear interrupt flag
+
+	id = e_last_mic_scan_id + 1;
+	if (id >= MIC_SAMP_NB)
+		id = 0;
+	e_mic_scan[0][id] = ADCBUF0;
+	e_mic_scan[1][id] = ADCBUF1;
+	e_mic_scan[2][id] = ADCBUF2;
+	e_last_mic_scan_id = id;
+
+	if (mic_blocks != NULL)
+	{
+		int *p = mic_blocks + mic_block_pos;
+
+		p[0] = ADCBUF0;
+		p[1] = ADCBUF1;
+		p[2] = ADCBUF2;
+		mic_block_pos += 3;
+		if (mic_block_pos == mic_block_size)
+			e_mic_block_count++;
+		else if (mic_block_pos == 2 * mic_block_size)
+		{
+			mic_block_pos = 0;
+			e_mic_block_count++;
+		}
+	}
+
+	id = e_last_acc_scan_id + 1;
+	if (id >= ACC_SAMP_NB)
+		id = 0;
+	e_acc_scan[0][id] = ADCBUF3;
+	e_acc_scan[1][id] = ADCBUF4;
+	e_acc_scan[2][id] = ADCBUF5;
+	e_last_acc_scan_id = id;
+
+	e_ad_scan_count++;
+
+	cur = &ad_slot_table[slot];
+	if (++slot_scan >= cur->scans)
+		end_slot(cur);
+	E_PROF_EXIT(E_PROF_ADC);
+}
+
+/* ---- user calls ---- */
+
+/*! \brief Initialize the ADC in scan mode and start it
+ *
+ * The ADC interrupt priority is kept below the camera (6) and UART (5)
+ * interrupts. The routine only has to finish before the next scan is
+ * complete (119 us).
+ *
+ * All the modules of this package call this function, only the first call
+ * configures the ADC. A running scan is never restarted.
+ */
+void e_init_ad_scan(void)
+{
+	if (running)
+		return;
+
+	ADCON1 = ADCON2 = ADCON3 = 0;
+	ADPCFG = 0x0003;		// AN0, AN1 digital (debugger), others analog
+
+	ADCON1bits.FORM = 0;		// integer output
+	ADCON1bits.SSRC = 7;		// internal counter ends sampling (auto-convert)
+	ADCON1bits.ASAM = 1;		// sampling starts after the last conversion
+	ADCON2bits.VCFG = 0;		// AVdd and AVss as references
+	ADCON2bits.CSCNA = 1;		// scan the inputs selected in ADCSSL
+	ADCON2bits.SMPI = AD_SCAN_CHANNELS - 1;	// interrupt after each scan
+	ADCON3bits.SAMC = SAMC_SCAN;
+	ADCON3bits.ADCS = ADCS_SCAN;
+
+	IPC2bits.ADIP = 3;		// priority level
+	build_schedule();
+	e_ad_scan_on();
+}
+
+/*! \brief Restart the scan stopped by \ref e_ad_scan_off
+ *
+ * The current slot is done again from its beginning.
+ */
+void e_ad_scan_on(void)
+{
+	slot_scan = 0;
+	ADCSSL = ad_slot_table[slot].ssl;
+	IFS0bits.ADIF = 0;		// clear interrupt flag
+	IEC0bits.ADIE = 1;		// set interrupt enable bit
+	ADCON1bits.ADON = 1;		// start the ADC
+	running = 1;
+}
+
+/*! \brief Stop the scan and switch off all the IR LEDs
+ *
+ * The arrays keep the last values. A pair stopped while its LEDs were on is
+ * measured again from the ambient light by \ref e_ad_scan_on.
+ */
+void e_ad_scan_off(void)
+{
+	ADCON1bits.ADON = 0;
+	IEC0bits.ADIE = 0;
+	PULSE_IR0 = PULSE_IR1 = PULSE_IR2 = PULSE_IR3 = 0;
+	if (ad_slot_table[slot].action == AD_SLOT_REFLECTED)
+		slot--;
+	running = 0;
+}
+
+/*! \brief Give the time base of the samples
+ * \return The number of scans since the initialization, one scan lasts
+ * \ref AD_SCAN_PERIOD_NS ns
+ */
+unsigned long e_ad_get_time(void)
+{
+	unsigned long now;
+
+	do {				// 32 bit reads are not atomic
+		now = e_ad_scan_count;
+	} while (now != e_ad_scan_count);
+	return now;
+}
+
+/*! \brief Get the latest sample of the three microphones
+ *
+ * The values and the stamp belong to the same scan. This only reads RAM and
+ * never stops the acquisition.
+ * \param sample Where to store MIC1..MIC3 and the stamp
+ */
+void e_ad_get_mic_sample(struct e_ad_sample *sample)
+{
+	unsigned int id;
+
+	do {
+		sample->stamp = e_ad_get_time();
+		id = e_last_mic_scan_id;
+		sample->value[0] = e_mic_scan[0][id];
+		sample->value[1] = e_mic_scan[1][id];
+		sample->value[2] = e_mic_scan[2][id];
+	} while (sample->stamp != e_ad_get_time());
+}
+
+/*! \brief Get the latest sample of the three accelerometer axes
+ *
+ * The values and the stamp belong to the same scan. This only reads RAM and
+ * never stops the acquisition.
+ * \param sample Where to store X, Y, Z and the stamp
+ */
+void e_ad_get_acc_sample(struct e_ad_sample *sample)
+{
+	unsigned int id;
+
+	do {
+		sample->stamp = e_ad_get_time();
+		id = e_last_acc_scan_id;
+		sample->value[0] = e_acc_scan[0][id];
+		sample->value[1] = e_acc_scan[1][id];
+		sample->value[2] = e_acc_scan[2][id];
+	} while (sample->stamp != e_ad_get_time());
+}
+
+/*! \brief Replacement of the blocking e_read_ad of a_d/e_ad_conv.c
+ *
+ * No conversion is started: the latest value stored by the scan is given.
+ * \param channel MIC1..MIC3, ACCX..ACCZ or IR0..IR7 (ambient light)
+ * \return The latest value of the channel, 0 if it is not scanned
+ */
+int e_read_ad(unsigned int channel)
+{
+	if (channel >= MIC1 && channel <= MIC3)
+		return e_mic_scan[channel - MIC1][e_last_mic_scan_id];
+	if (channel >= ACCX && channel <= ACCZ)
+		return e_acc_scan[channel - ACCX][e_last_acc_scan_id];
+	if (channel >= IR0 && channel <= IR7)
+		return e_ambient_ir[channel - IR0];
+	return 0;
+}
+
+/*! \brief Select the IR pairs scanned and their timing
+ *
+ * A cycle takes (gap + pulse) scans per pair, plus the wait of
+ * \ref e_ad_set_prox_wait. The default is all the pairs, a gap of 18 and a
+ * pulse of \ref AD_IR_PULSE_SCANS scans (10 ms). The values of the pairs
+ * left out are kept. The new schedule starts at once with a new cycle.
+ * \param pairs Bit mask of the pairs, bit n for IRn and IRn+4
+ * \param pulse Scans with the IR LEDs on, at least 1
+ * \param gap Scans before the pulse, with the LEDs off, at least 2 (the
+ * first scan after a change of pair may convert the previous pair)
+ */
+void e_ad_set_prox_schedule(unsigned int pairs, unsigned int pulse,
+		unsigned int gap)
+{
+	prox_pairs = pairs & 0x0F;
+	prox_pulse = (pulse < 1) ? 1 : pulse;
+	prox_gap = (gap < 2) ? 2 : gap;
+	if (running)
+		apply_schedule();
+}
+
+/*! \brief Add a wait at the end of each proximity cycle
+ *
+ * With the LEDs off, this lowers the rate of the cycles (e.g. while the
+ * robot stands still). The microphones and the accelerometer are still
+ * sampled at the scan rate.
+ * \param scans Length of the wait, 0 for none
+ */
+void e_ad_set_prox_wait(unsigned int scans)
+{
+	if (scans == prox_wait)
+		return;
+	prox_wait = scans;
+	if (running)
+		apply_schedule();
+}
+
+/*! \brief Set a function called at the end of each proximity cycle
+ *
+ * It runs in the ADC interrupt and must be short.
+ * \param callback The function, or NULL
+ */
+void e_ad_set_prox_callback(void (*callback)(void))
+{
+	prox_callback = callback;
+}
+
+/*! \brief Capture the microphones into two blocks, one after the other
+ *
+ * Each scan stores MIC1, MIC2 and MIC3 at the end of the current block.
+ * While a block is filled, the other one can be read, see
+ * \ref e_ad_get_mic_block. The microphones of one scan are converted
+ * 1/8 of a scan apart.
+ * \param buffer The two blocks, 2 * 3 * length ints, NULL to stop
+ * \param length The number of scans per block
+ */
+void e_ad_set_mic_blocks(int *buffer, unsigned int length)
+{
+	unsigned int ie = IEC0bits.ADIE;
+
+	IEC0bits.ADIE = 0;
+	mic_blocks = buffer;
+	mic_block_size = 3 * length;
+	mic_block_pos = 0;
+	e_mic_block_count = 0;
+	IEC0bits.ADIE = ie;
+}
+
+/*! \brief Get the last complete block of the microphones
+ *
+ * The block holds length triples (MIC1, MIC2, MIC3). It stays valid until
+ * \ref e_mic_block_count is incremented again: the interrupt then refills
+ * it with the next block.
+ * \param count Where to store the number of the block, or NULL
+ * \return The block, NULL if none is complete
+ */
+const int *e_ad_get_mic_block(unsigned int *count)
+{
+	unsigned int n = e_mic_block_count;	// odd after the first block
+
+	if (count != NULL)
+		*count = n;
+	if ((mic_blocks == NULL) || (n == 0))
+		return NULL;
+	return (n & 1) ? mic_blocks : mic_blocks + mic_block_size;
+}
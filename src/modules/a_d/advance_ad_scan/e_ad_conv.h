@@ -0,0 +1,101 @@
+/*! \file
+ * \ingroup a_d
+ * \brief Module for the Analogic/Digital conversion (ADC interrupt scan).
+ *
+ * In this approach the ADC runs on its own: the auto-sample and auto-convert
+ * sequencing scans the three microphones, the three accelerometer axes and
+ * one pair of proximity sensors, then raises the ADC interrupt. The interrupt
+ * routine copies the results into the arrays below and pulses the IR LEDs of
+ * the proximity sensors, one pair after the other.
+ *
+ * No conversion is ever started or waited for by the user functions
+ * (\ref e_get_prox, \ref e_get_micro, \ref e_get_acc), they only read RAM.
+ *
+ * The ADC has a single owner: the sequence of scans is described by a fixed
+ * slot table (see e_ad_conv.c). Every scan converts the microphones and the
+ * accelerometer, the slot decides which IR pair is converted with them and
+ * what is done with it. Every ADC interrupt increments \ref e_ad_scan_count,
+ * which is used as the timestamp of the samples (\ref e_ad_get_mic_sample,
+ * \ref e_ad_get_acc_sample).
+ *
+ * Timing of one scan (8 conversions):
+ * - Tad = (ADCS + 1) * Tcy / 2 = 678 ns,
+ * - one conversion = (SAMC + 14) * Tad = 14.9 us,
+ * - one scan = 119.4 us, the ADC interrupt runs at about 8.4 kHz.
+ *
+ * A proximity pair takes \ref AD_IR_PAIR_SCANS scans (about 2.5 ms), the
+ * LEDs of the pair are on during the last \ref AD_IR_PULSE_SCANS scans
+ * (about 350 us). A complete 8 sensor cycle takes about 10 ms, like the
+ * timer1 version. The pairs and these timings can be changed with
+ * \ref e_ad_set_prox_schedule, and the cycles slowed down with
+ * \ref e_ad_set_prox_wait.
+ *
+ * Each reflected value, minus the offset of its sensor (\ref e_prox_offset,
+ * see \ref e_calibrate_prox), also goes through the median of its last three
+ * values and an exponential filter of \ref AD_PROX_FILTER. The results are in
+ * \ref e_prox_filtered, \ref e_ad_prox_cycle counts their updates.
+ *
+ * \warning This module uses the ADC interrupt. It does not use any timer.
+ * \author Code: Darius Kellermann
+ */
+
+#ifndef _AD_CONV_SCAN
+#define _AD_CONV_SCAN
+
+#define ADCS_SCAN		19	/*!< Tad = 20 Tcy / 2 = 678 ns */
+#define SAMC_SCAN		8	/*!< Auto-sample time in Tad */
+#define AD_SCAN_CHANNELS	8	/*!< Conversions per ADC interrupt */
+
+#define AD_IR_PULSE_SCANS	3	/*!< Scans with the IR LEDs on (358 us) */
+#define AD_IR_PAIR_SCANS	21	/*!< Scans per proximity pair (2.5 ms) */
+
+#define AD_SCAN_PERIOD_NS	119400L	/*!< Duration of one scan */
+
+#define AD_PROX_FILTER		2	/*!< The filter keeps 1 - 2^-2 of the past */
+
+#define MIC_SAMP_NB		32	/*!< Samples kept for each microphone */
+#define ACC_SAMP_NB		16	/*!< Samples kept for each axis */
+
+/* ADCBUFx index of each channel, they are converted in ascending order */
+#define AD_BUF_MIC1		0
+#define AD_BUF_ACCX		3
+#define AD_BUF_IR_LOW		6	/* IR0..IR3 */
+#define AD_BUF_IR_HIGH		7	/* IR4..IR7 */
+
+extern int e_mic_scan[3][MIC_SAMP_NB];
+extern int e_acc_scan[3][ACC_SAMP_NB];
+extern unsigned int e_last_mic_scan_id;
+extern unsigned int e_last_acc_scan_id;
+
+extern int e_ambient_ir[8];
+extern int e_ambient_and_reflected_ir[8];
+extern int e_reflected_ir[8];
+extern int e_prox_offset[8];
+extern int e_prox_filtered[8];
+
+extern volatile unsigned long e_ad_scan_count;
+extern volatile unsigned int e_ad_prox_cycle;
+extern volatile unsigned int e_mic_block_count;
+
+/*! The latest sample of a three channel sensor */
+struct e_ad_sample {
+	int value[3];		/*!< One value per channel */
+	unsigned long stamp;	/*!< \ref e_ad_scan_count of the acquisition */
+};
+
+/* functions */
+void e_init_ad_scan(void);	// to be used at the beginning to initialize AD
+void e_ad_scan_on(void);	// restart the scan after e_ad_scan_off
+void e_ad_scan_off(void);	// stop the ADC and switch off the IR LEDs
+unsigned long e_ad_get_time(void);	// current scan count
+void e_ad_get_mic_sample(struct e_ad_sample *sample);	// latest microphone sample
+void e_ad_get_acc_sample(struct e_ad_sample *sample);	// latest accelerometer sample
+void e_ad_set_prox_schedule(unsigned int pairs, unsigned int pulse,
+		unsigned int gap);	// IR pairs scanned and their timing
+void e_ad_set_prox_wait(unsigned int scans);	// wait after each cycle
+void e_ad_set_prox_callback(void (*callback)(void));	// end of cycle hook
+void e_ad_set_mic_blocks(int *buffer, unsigned int length);	// mic capture
+const int *e_ad_get_mic_block(unsigned int *count);	// last complete block
+int e_read_ad(unsigned int channel);	// latest value of a scanned channel
+
+#endif
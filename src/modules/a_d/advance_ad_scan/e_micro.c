@@ -0,0 +1,35 @@
+/*! \file
+ * \ingroup a_d
+ * \brief Accessing the microphone data (ADC interrupt scan).
+ * \author Code: Darius Kellermann
+ */
+
+#include "e_ad_conv.h"
+#include "e_micro.h"
+
+/*! \brief Init the ADC scan
+ * \warning Must be called before starting using microphone. If the
+ * proximity sensors are already initialized, this is not needed.
+ */
+void e_init_micro(void)
+{
+	e_init_ad_scan();
+}
+
+/*! \brief To get the last m0, m1, m2 microphones's values
+ *
+ * The three values come from the same scan. The proximity sensors keep
+ * running, use \ref e_ad_get_mic_sample to get the time of the sample too.
+ * \param m0 A pointer to store the m0 analogic value
+ * \param m1 A pointer to store the m1 analogic value
+ * \param m2 A pointer to store the m2 analogic value
+ */
+void e_get_micro(int *m0, int *m1, int *m2)
+{
+	struct e_ad_sample sample;
+
+	e_ad_get_mic_sample(&sample);
+	*m0 = sample.value[0];
+	*m1 = sample.value[1];
+	*m2 = sample.value[2];
+}
@@ -0,0 +1,20 @@
+/*! \file
+ * \ingroup a_d
+ * \brief Accessing the microphone data (ADC interrupt scan).
+ *
+ * Same interface as a_d/e_micro.h. The samples are acquired by the ADC
+ * interrupt (see e_ad_conv.h), the last \ref MIC_SAMP_NB samples of each
+ * microphone are available in \ref e_mic_scan. For longer records, the
+ * ADC interrupt can also fill two blocks in turn, see
+ * \ref e_ad_set_mic_blocks.
+ * \author Code: Darius Kellermann
+ */
+
+#ifndef _MICROPHONE_SCAN
+#define _MICROPHONE_SCAN
+
+/* functions */
+void e_init_micro(void);   // to be called before starting using microphone
+void e_get_micro(int *m1, int *m2,int *m3); // to get analog value of microphone
+
+#endif
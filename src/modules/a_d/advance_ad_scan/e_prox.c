@@ -0,0 +1,178 @@
+/*! \file
+ * \ingroup a_d
+ * \brief Accessing proximity sensor of e-puck (ADC interrupt scan).
+ * \author Code: Darius Kellermann
+ */
+
+#include <libpic30.h>
+
+#include "e_ad_conv.h"
+#include "e_prox.h"
+
+#define PROX_EE_MAGIC	0x5043	// "CP", the offsets below are valid
+
+/* the calibration in the data EEPROM: the offsets, then the magic */
+static int __attribute__((space(eedata), aligned(2))) ee_prox[9];
+
+/*! \brief Init the ADC scan, which also pulses the IR LEDs
+ * \warning Must be called before starting using proximity sensor
+ */
+void e_init_prox(void)
+{
+	e_init_ad_scan();
+}
+
+/*! \brief Stop the acquisition (stop the ADC scan)
+ * \warning This also stops the microphones and the accelerometer
+ */
+void e_stop_prox(void)
+{
+	e_ad_scan_off();
+}
+
+/*! \brief To get the analogic proxy sensor value of a specific sensor
+ *
+ * The result value of this function is: reflected light, that is the
+ * ambient light minus the light measured with the IR led on (see
+ * a_d/e_prox.c). More this value is great, more the obstacle is near.
+ * \param sensor_number The proxy sensor's number that you want the value.
+ *                      Must be between 0 to 7.
+ * \return The analogic value of the specified proxy sensor
+ */
+int e_get_prox(unsigned int sensor_number)
+{
+	if (sensor_number > 7)
+		return 0;
+	else
+		return e_reflected_ir[sensor_number];
+}
+
+/*! \brief To get the analogic ambient light value of a specific sensor
+ * \param sensor_number The proxy sensor's number that you want the value.
+ *                      Must be between 0 to 7.
+ * \return The analogic value of the ambient light on the specified sensor
+ */
+int e_get_ambient_light(unsigned int sensor_number)
+{
+	if (sensor_number > 7)
+		return 0;
+	else
+		return e_ambient_ir[sensor_number];
+}
+
+/*! \brief To get the calibrated and filtered value of a specific sensor
+ *
+ * This is \ref e_get_prox minus the offset of the sensor, never negative,
+ * through a median of three and an exponential filter. It changes once per
+ * proximity cycle.
+ * \param sensor_number The proxy sensor's number that you want the value.
+ *                      Must be between 0 to 7.
+ * \return The filtered value of the specified proxy sensor
+ */
+int e_get_prox_filtered(unsigned int sensor_number)
+{
+	if (sensor_number > 7)
+		return 0;
+	else
+		return e_prox_filtered[sensor_number];
+}
+
+/*! \brief Update a copy of the filtered values, if they changed
+ *
+ * Nothing is read while no proximity cycle is complete since the last call.
+ * \param values The caller's copy of the 8 filtered values
+ * \param cycle The proximity cycle of the copy, updated
+ * \return The bit mask of the sensors whose value changed, 0 if none
+ */
+unsigned int e_get_prox_changed(int *values, unsigned int *cycle)
+{
+	unsigned int i, mask = 0;
+	int v;
+
+	if (*cycle == e_ad_prox_cycle)
+		return 0;
+	*cycle = e_ad_prox_cycle;
+	for (i = 0; i < 8; i++)
+	{
+		v = e_prox_filtered[i];
+		if (v != values[i])
+		{
+			values[i] = v;
+			mask |= 1 << i;
+		}
+	}
+	return mask;
+}
+
+/*! \brief Measure the offset of each sensor
+ *
+ * The offset is the mean reflected light over \ref PROX_CALIB_CYCLES
+ * proximity cycles, it is then substracted from each value by the ADC
+ * interrupt. This blocks for as many cycles of the schedule set by
+ * \ref e_ad_set_prox_schedule, (gap + pulse) scans of 119.4 us per pair
+ * plus the wait: 160 ms with the default (10 ms), 92 ms with the 4 pairs of
+ * 12 scans of puck2bt (5.7 ms).
+ * \warning Nothing must be in the range of the sensors. The ADC scan must
+ * be running (\ref e_init_prox).
+ */
+void e_calibrate_prox(void)
+{
+	long sum[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	unsigned int cycle = e_ad_prox_cycle, n, i;
+
+	for (n = 0; n < PROX_CALIB_CYCLES; n++)
+	{
+		while (cycle == e_ad_prox_cycle)
+			;
+		cycle = e_ad_prox_cycle;
+		for (i = 0; i < 8; i++)
+			sum[i] += e_reflected_ir[i];
+	}
+	for (i = 0; i < 8; i++)
+		e_prox_offset[i] = sum[i] / PROX_CALIB_CYCLES;
+}
+
+/*! \brief Load the offsets saved by \ref e_prox_save_calibration
+ * \return 1 if they were loaded, 0 if the EEPROM holds no calibration
+ */
+int e_prox_load_calibration(void)
+{
+	_prog_addressT p;
+	int ee[9], i;
+
+	_init_prog_address(p, ee_prox);
+	_memcpy_p2d16(ee, p, sizeof(ee));
+	if (ee[8] != PROX_EE_MAGIC)
+		return 0;
+	for (i = 0; i < 8; i++)
+		e_prox_offset[i] = ee[i];
+	return 1;
+}
+
+/*! \brief Save the offsets in the data EEPROM
+ *
+ * Each word is erased and written, this blocks about 40 ms. The magic word
+ * is erased first and written last, so an interrupted save leaves no valid
+ * calibration.
+ */
+void e_prox_save_calibration(void)
+{
+	_prog_addressT p;
+	int i, v;
+
+	_init_prog_address(p, ee_prox);
+	for (i = 0; i < 9; i++, p += 2)
+	{
+		v = (i < 8) ? e_prox_offset[i] : PROX_EE_MAGIC;
+		if (i == 0)
+		{
+			// erase the magic first, it is written again last
+			_erase_eedata(p + 16, _EE_WORD);
+			_wait_eedata();
+		}
+		_erase_eedata(p, _EE_WORD);
+		_wait_eedata();
+		_write_eedata_word(p, v);
+		_wait_eedata();
+	}
+}
@@ -0,0 +1,47 @@
+/*! \file
+ * \ingroup a_d
+ * \brief Accessing proximity sensor of e-puck (ADC interrupt scan).
+ *
+ * Same interface as the timer1 version (a_d/e_prox.h), but the values are
+ * acquired by the ADC interrupt (see e_ad_conv.h). The functions only read
+ * the last values from RAM.
+ *
+ * \ref e_get_prox gives the raw reflected light. \ref e_get_prox_filtered
+ * gives it minus an offset per sensor, measured by \ref e_calibrate_prox
+ * and kept in the data EEPROM, and filtered by the ADC interrupt.
+ * \code
+ * #include <p30f6014A.h>
+ * #include <motor_led/e_epuck_ports.h>
+ * #include <motor_led/e_init_port.h>
+ * #include <a_d/advance_ad_scan/e_prox.h>
+ *
+ * int main(void)
+ * {
+ * 	e_init_port();
+ * 	e_init_prox();
+ * 	while(1)
+ * 		LED0 = e_get_prox(0) > 1000;	//LED0 on if an obstacle is detected by proxy0
+ * }
+ * \endcode
+ * \warning This module uses the ADC interrupt, but no timer
+ * \author Code: Darius Kellermann
+ */
+
+#ifndef _PROX_SCAN
+#define _PROX_SCAN
+
+#define PROX_CALIB_CYCLES	16	// proximity cycles averaged by e_calibrate_prox
+
+/* functions */
+
+void e_init_prox(void);   // to be called before starting using prox
+void e_stop_prox(void); //Stop the scan and put pulse to 0
+int e_get_prox(unsigned int sensor_number); // to get a prox value
+int e_get_ambient_light(unsigned int sensor_number); // to get ambient light value
+int e_get_prox_filtered(unsigned int sensor_number); // calibrated and filtered value
+unsigned int e_get_prox_changed(int *values, unsigned int *cycle); // changed filtered values
+void e_calibrate_prox(void);	// measure the offsets of the sensors
+int e_prox_load_calibration(void);	// offsets from the data EEPROM
+void e_prox_save_calibration(void);	// offsets to the data EEPROM
+
+#endif
@@ -10,6 +10,9 @@
 #include "../../I2C/e_I2C_protocol.h"
 #include "../../motor_led/e_init_port.h"
 
+/* not built for the other sensor, see POXXXX_SENSOR */
+#if POXXXX_SENSOR != POXXXX_PO6030K
+
 #define 	ARRAY_ORIGINE_X	210
 #define		ARRAY_ORIGINE_Y 7
 
@@ -177,3 +180,5 @@ int e_po3030k_get_bytes_per_pixel(int color_mode) {
 	/* UNKNOW ! */
 	return 1;
 }
+
+#endif /* POXXXX_SENSOR */
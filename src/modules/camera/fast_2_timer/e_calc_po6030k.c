@@ -8,6 +8,9 @@
 #include "../../I2C/e_I2C_protocol.h"
 #include "../../motor_led/e_init_port.h"
 
+/* not built for the other sensor, see POXXXX_SENSOR */
+#if POXXXX_SENSOR != POXXXX_PO3030K
+
 #define 	ARRAY_ORIGINE_X	80
 #define		ARRAY_ORIGINE_Y 8
 
@@ -183,3 +186,4 @@ int e_po6030k_get_bytes_per_pixel(int color_mode) {
 
 	
 
+#endif /* POXXXX_SENSOR */
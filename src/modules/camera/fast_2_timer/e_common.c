@@ -5,7 +5,14 @@
 #include "../../I2C/e_I2C_protocol.h"
 #include "../../motor_led/e_init_port.h"
 
+#define HAS_PO3030K	(POXXXX_SENSOR != POXXXX_PO6030K)
+#define HAS_PO6030K	(POXXXX_SENSOR != POXXXX_PO3030K)
+
+#if POXXXX_SENSOR == POXXXX_AUTO
 static int camera_version;
+#else
+#define camera_version	POXXXX_SENSOR
+#endif
 
 
 int e_poxxxx_config_cam(unsigned int sensor_x1,unsigned int sensor_y1,
@@ -13,18 +20,22 @@ int e_poxxxx_config_cam(unsigned int sensor_x1,unsigned int sensor_y1,
 				unsigned int zoom_fact_width,unsigned int zoom_fact_height,  
 				int color_mode) {
 	switch(camera_version) {
+#if HAS_PO3030K
 		case 0x3030:
 			return e_po3030k_config_cam(sensor_x1, sensor_y1,
 				sensor_width, sensor_height,
 				zoom_fact_width, zoom_fact_height,  
 				color_mode);
 			break;
+#endif
+#if HAS_PO6030K
 		case 0x6030:
 			return e_po6030k_config_cam(sensor_x1, sensor_y1,
 				sensor_width, sensor_height,
 				zoom_fact_width, zoom_fact_height,  
 				color_mode);
 			break;
+#endif
 		default:
 			return -1;
 	}
@@ -33,44 +44,114 @@ int e_poxxxx_config_cam(unsigned int sensor_x1,unsigned int sensor_y1,
 
 void e_poxxxx_set_mirror(int vertical, int horizontal) {
 	switch(camera_version) {
+#if HAS_PO3030K
 		case 0x3030:
 			e_po3030k_set_mirror(vertical, horizontal);
 			break;
+#endif
+#if HAS_PO6030K
 		case 0x6030:
 			e_po6030k_set_mirror(vertical, horizontal);
 			break;
+#endif
 	}
 }
 
 void e_poxxxx_write_cam_registers(void) {
 	switch(camera_version) {
+#if HAS_PO3030K
 		case 0x3030:
 			e_po3030k_write_cam_registers();
 			break;
+#endif
 		case 0x6030:
 			// Nothing to do
 			break;
 	}
 }
 
+/*! Write the camera registers without waiting, see
+ * \a e_po3030k_write_cam_registers_async.
+ * The po6030k registers are written when they are set, so there is
+ * nothing to do.
+ */
+void e_poxxxx_write_cam_registers_async(void) {
+	switch(camera_version) {
+#if HAS_PO3030K
+		case 0x3030:
+			e_po3030k_write_cam_registers_async(0);
+			break;
+#endif
+		case 0x6030:
+			// Nothing to do
+			break;
+	}
+}
+
+/*! Check if the camera registers are being written
+ * \return Non-zero until the end of the last \a e_poxxxx_write_cam_registers_async
+ */
+int e_poxxxx_cam_registers_busy(void) {
+	switch(camera_version) {
+#if HAS_PO3030K
+		case 0x3030:
+			return e_po3030k_cam_registers_busy();
+#endif
+		default:
+			return 0;
+	}
+}
+
 #define DEVICE_ID 0xDC
 void e_poxxxx_init_cam(void) {
 	int i;
+#if POXXXX_SENSOR == POXXXX_AUTO
 	unsigned char reg0, reg1;
+#endif
 	e_init_port();
 	e_i2cp_init();
 	CAM_RESET=0;
 	for(i=100;i;i--) __asm__ volatile ("nop");
 	CAM_RESET=1;
 	for(i=100;i;i--) __asm__ volatile ("nop");
+#if HAS_PO6030K
+	e_po6030k_forget_bank();
+#endif
 	/* enable interrupt nesting */
 	INTCON1bits.NSTDIS = 0;
 	/* set a higher priority on camera's interrupts */
 	IPC5 = (IPC5 & 0xF00F) + 0x0660;
 
+#if POXXXX_SENSOR == POXXXX_AUTO
 	/* read the camera version */
 	reg0 = e_i2cp_read(DEVICE_ID, 0x0);
 	reg1 = e_i2cp_read(DEVICE_ID, 0x1);
 	camera_version = reg0 << 8 | reg1;
+#endif
+}
+
+/*! Put the sensor in standby
+ *
+ * The sensor is held in reset, it stops its readout and its clocks to the
+ * capture. No capture may be in progress.
+ * \sa e_poxxxx_wake_cam
+ */
+void e_poxxxx_sleep_cam(void) {
+	CAM_RESET=0;
+}
+
+/*! Wake the sensor up from \a e_poxxxx_sleep_cam
+ *
+ * The sensor lost its registers, it must be configured again as after
+ * \a e_poxxxx_init_cam.
+ */
+void e_poxxxx_wake_cam(void) {
+	int i;
+
+	CAM_RESET=1;
+	for(i=100;i;i--) __asm__ volatile ("nop");
+#if HAS_PO6030K
+	e_po6030k_forget_bank();
+#endif
 }
 
@@ -0,0 +1,195 @@
+/*! \file
+ * \ingroup camera1
+ * \brief Pool of frame buffers for continuous capture
+ * \author Code: Darius Kellermann
+ */
+
+#include <stddef.h>
+
+#include "e_poxxxx.h"
+#include "e_frame_pool.h"
+
+#define FRAME_FREE	0	/* can be used for the next capture */
+#define FRAME_CAPTURING	1	/* the camera writes into it */
+#define FRAME_READY	2	/* captured, not yet taken */
+#define FRAME_BUSY	3	/* taken by the user */
+
+static char *frame_buf[E_POXXXX_POOL_MAX];
+static unsigned char frame_state[E_POXXXX_POOL_MAX];
+static unsigned int frame_seq[E_POXXXX_POOL_MAX];	// capture order
+
+static int frame_nb = 0;
+static int capturing = -1;		// buffer being captured, -1 if none
+static int streamed = -1;		// buffer taken during its capture
+static int running = 0;
+static unsigned int seq = 0;		// number of captures done
+static unsigned int dropped = 0;	// ready frames captured again
+
+/* the oldest buffer in the given state, -1 if none */
+static int oldest(unsigned char state)
+{
+	int i, found = -1;
+
+	for (i = 0; i < frame_nb; i++)
+		if (frame_state[i] == state && (found < 0 ||
+				(seq - frame_seq[i]) > (seq - frame_seq[found])))
+			found = i;
+	return found;
+}
+
+static void launch_next(void)
+{
+	int i;
+
+	if (!running || capturing >= 0)
+		return;
+
+	i = oldest(FRAME_FREE);
+	if (i < 0) {
+		i = oldest(FRAME_READY);
+		if (i < 0)
+			return;		// all the buffers are busy
+		dropped++;
+	}
+	frame_state[i] = FRAME_CAPTURING;
+	capturing = i;
+	e_poxxxx_launch_capture(frame_buf[i]);
+}
+
+/*! Give the buffers to the pool
+ * \param bufs The buffers, each one must be large enough for one image
+ * \param count The number of buffers, at most \ref E_POXXXX_POOL_MAX
+ * \warning The camera must be configured, the pool is stopped.
+ */
+void e_poxxxx_pool_init(char *bufs[], int count) {
+	int i;
+
+	if (count > E_POXXXX_POOL_MAX)
+		count = E_POXXXX_POOL_MAX;
+	for (i = 0; i < count; i++) {
+		frame_buf[i] = bufs[i];
+		frame_state[i] = FRAME_FREE;
+	}
+	frame_nb = count;
+	capturing = -1;
+	streamed = -1;
+	running = 0;
+	dropped = 0;
+}
+
+/*! Start the continuous capture
+ * \sa e_poxxxx_pool_stop
+ */
+void e_poxxxx_pool_start(void) {
+	running = 1;
+	launch_next();
+}
+
+/*! Stop the continuous capture
+ *
+ * A capture in progress still ends in its buffer, no new one is launched.
+ */
+void e_poxxxx_pool_stop(void) {
+	running = 0;
+}
+
+/*! Check if a capture is in progress
+ *
+ * Once the pool is stopped, the camera is idle when this returns zero.
+ * \return Non-zero until the end of the current capture
+ */
+int e_poxxxx_pool_capturing(void) {
+	e_poxxxx_pool_update();
+	return capturing >= 0;
+}
+
+/*! Handle the end of the current capture
+ *
+ * Moves the captured frame to the ready state and launches the next
+ * capture. Called by \ref e_poxxxx_pool_get_ready, call it often if the
+ * ready frames are not taken.
+ * \return The number of ready frames
+ */
+int e_poxxxx_pool_update(void) {
+	int i, ready = 0;
+
+	if (capturing >= 0 && e_poxxxx_is_img_ready()) {
+		if (capturing == streamed) {
+			frame_state[capturing] = FRAME_BUSY;
+			streamed = -1;
+		}
+		else
+			frame_state[capturing] = FRAME_READY;
+		frame_seq[capturing] = seq++;
+		capturing = -1;
+	}
+	launch_next();
+
+	for (i = 0; i < frame_nb; i++)
+		if (frame_state[i] == FRAME_READY)
+			ready++;
+	return ready;
+}
+
+/*! Take the oldest ready frame
+ * \return The buffer of the frame, NULL if no frame is ready
+ * \sa e_poxxxx_pool_release
+ */
+char *e_poxxxx_pool_get_ready(void) {
+	int i;
+
+	e_poxxxx_pool_update();
+	i = oldest(FRAME_READY);
+	if (i < 0)
+		return NULL;
+	frame_state[i] = FRAME_BUSY;
+	return frame_buf[i];
+}
+
+/*! Take the frame being captured
+ *
+ * A capture is launched if the camera is idle. The rows can be used as soon
+ * as \ref e_poxxxx_pool_rows counts them, the frame is busy at the end of
+ * the capture and must be released like a ready one.
+ * \return The buffer of the frame, NULL if no capture can be launched
+ */
+char *e_poxxxx_pool_stream(void) {
+	e_poxxxx_pool_update();
+	if (capturing < 0)
+		return NULL;
+	streamed = capturing;
+	return frame_buf[capturing];
+}
+
+/*! Give the number of rows already captured in a frame
+ * \param buf A buffer taken with \ref e_poxxxx_pool_stream or
+ * \ref e_poxxxx_pool_get_ready
+ * \return The number of rows that can be used
+ */
+int e_poxxxx_pool_rows(const char *buf) {
+	e_poxxxx_pool_update();
+	if (capturing >= 0 && frame_buf[capturing] == buf)
+		return e_poxxxx_rows_done();
+	return e_poxxxx_rows_total();
+}
+
+/*! Give back a buffer taken with \ref e_poxxxx_pool_get_ready
+ *
+ * If the camera is idle, the next capture starts in this buffer at once.
+ * \param buf The buffer
+ */
+void e_poxxxx_pool_release(char *buf) {
+	int i;
+
+	for (i = 0; i < frame_nb; i++)
+		if (frame_buf[i] == buf && frame_state[i] == FRAME_BUSY)
+			frame_state[i] = FRAME_FREE;
+	launch_next();
+}
+
+/*! Give the number of ready frames captured again before being taken
+ * \return The number of dropped frames since \ref e_poxxxx_pool_init
+ */
+unsigned int e_poxxxx_pool_dropped(void) {
+	return dropped;
+}
@@ -0,0 +1,45 @@
+/*! \file
+ * \ingroup camera1
+ * \brief Pool of frame buffers for continuous capture
+ *
+ * The pool owns a few buffers given by the user. Each buffer goes through
+ * the states free -> capturing -> ready -> busy (used by the user, e.g.
+ * being sent) -> free. As soon as the camera is idle and a buffer is free,
+ * the next capture is launched in it, so the user only takes ready frames
+ * and gives them back.
+ *
+ * If no buffer is free when a capture ends, the oldest ready frame is
+ * captured again: the ready frames are always the most recent ones.
+ *
+ * A frame can also be taken while it is captured (\ref e_poxxxx_pool_stream),
+ * to use its rows as they come. It is busy at the end of the capture.
+ * \author Code: Darius Kellermann
+ */
+
+#ifndef __FRAME_POOL_H__
+#define __FRAME_POOL_H__
+
+/*! Maximum number of buffers in the pool */
+#define E_POXXXX_POOL_MAX	4
+
+void e_poxxxx_pool_init(char *bufs[], int count);
+
+void e_poxxxx_pool_start(void);
+
+void e_poxxxx_pool_stop(void);
+
+int e_poxxxx_pool_capturing(void);
+
+int e_poxxxx_pool_update(void);
+
+char *e_poxxxx_pool_get_ready(void);
+
+char *e_poxxxx_pool_stream(void);
+
+int e_poxxxx_pool_rows(const char *buf);
+
+void e_poxxxx_pool_release(char *buf);
+
+unsigned int e_poxxxx_pool_dropped(void);
+
+#endif
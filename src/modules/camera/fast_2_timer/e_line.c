@@ -0,0 +1,57 @@
+/*! \file
+ * \ingroup camera1
+ * \brief Description of the camera line read by the HSYNC interrupt
+ * \author Code: Darius Kellermann
+ * \verbinclude e_interrupt.S
+ *
+ * It touches no register, the host replay (tools/puck_sim.c) builds it to
+ * check the lines of every geometry.
+ */
+
+#include "e_poxxxx.h"
+
+/*! The line description, read by the HSYNC interrupt
+ * \sa e_poxxxx_apply_timer_config
+ */
+int _poxxxx_pixel_cnt;
+int _poxxxx_skip_cnt;
+int _poxxxx_loop;
+
+/*! The rows to ignore between two rows taken, loaded in Timer4 */
+int _poxxxx_blank_row;
+
+/* The number of rows to take, near for the HSYNC interrupt (e_timers.c) */
+extern int _poxxxx_row;
+
+/* The offsets of the HSYNC loops, defined in e_interrupt.S */
+extern const int _poxxxx_loop_offsets[4];
+
+/*! Modify the interrupt configuration
+ *
+ * The line is described as \a pixel_col times "take \a bpp bytes, skip
+ * \a pbp * \a bpp bytes", the HSYNC interrupt picks the loop for \a bpp and
+ * waits for the skipped bytes with a REPEAT. The width of the rows is thus
+ * only bounded by the REPEAT count, which holds the skipped bytes in cycles.
+ * \warning This is an internal function, use \a e_poxxxx_config_cam
+ * \param pixel_row The number of row to take
+ * \param pixel_col The number of pixel to take each \a pixel_row
+ * \param bpp The number of byte per pixel (1 or 2)
+ * \param pbp The number of pixel to ignore between each pixel
+ * \param bbl The number of row to ignore between each line
+ * \return Zero if OK, non-zero if the mode exceed internal data representation
+ * \sa e_poxxxx_config_cam
+ */
+int e_poxxxx_apply_timer_config(int pixel_row, int pixel_col, int bpp, int pbp, int bbl) {
+	long skip = 8L * pbp * bpp;	/* cycles of the skipped bytes */
+
+	if(pixel_col < 1 || bpp < 1 || bpp > 2 || pbp < 0 || skip > 0x4000)
+		return -1;
+
+	_poxxxx_pixel_cnt = pixel_col;
+	_poxxxx_skip_cnt = skip - 1;	/* REPEAT runs count + 1 times */
+	_poxxxx_loop = _poxxxx_loop_offsets[(bpp - 1) * 2 + (skip != 0)];
+	_poxxxx_blank_row = bbl;
+	_poxxxx_row = pixel_row;
+
+	return 0;
+}
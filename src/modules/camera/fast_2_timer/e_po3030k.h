@@ -117,11 +117,16 @@ int main(void) {
 #define __PO3030K_H__
 
 #include "e_poxxxx.h"
+#include "../../I2C/e_I2C_queue.h"
 
 /*! If you set this at 0, you save about 168 bytes of memory
  * But you loose all advanced camera functions */
 #define PO3030K_FULL 1
 
+/*! The longest burst of consecutive registers written at once, set it at
+ * 1 to write the registers one by one */
+#define PO3030K_BURST 8
+
 #define MODE_VGA 			0x44
 #define MODE_QVGA 			0x11
 #define MODE_QQVGA 			0x33
@@ -146,6 +151,10 @@ void e_po3030k_init_cam(void);
 
 void e_po3030k_write_cam_registers(void);
 
+void e_po3030k_write_cam_registers_async(void (*done)(struct e_i2cq_trans *t));
+
+int  e_po3030k_cam_registers_busy(void);
+
 int  e_po3030k_set_color_mode(int mode);
 
 int  e_po3030k_set_sampling_mode(int mode);
@@ -9,6 +9,9 @@
 #include "../../I2C/e_I2C_protocol.h"
 #include "e_po3030k.h"
 
+/* not built for the other sensor, see POXXXX_SENSOR */
+#if POXXXX_SENSOR != POXXXX_PO6030K
+
 #define MCLK				((long) 14745600)  /* 14.7456Mhz */
 #define MCLK_P_NS			0.067816840278 /* Master clock period in ns */
 
@@ -205,30 +208,120 @@ static unsigned char cam_reg[] = {
 };
 #define NB_REGISTERS (sizeof(cam_reg)/(2*sizeof(cam_reg[0])))
 
+/* One bit per register of cam_reg, set when the camera holds the value.
+ * A register is dirty when its bit is cleared, so everything is dirty at
+ * startup. */
+static unsigned char cam_synced[(NB_REGISTERS + 7) / 8];
+#define IS_DIRTY(n)	(!(cam_synced[(n) >> 3] & (1 << ((n) & 7))))
+#define SET_DIRTY(n)	(cam_synced[(n) >> 3] &= ~(1 << ((n) & 7)))
+#define CLEAR_DIRTY(n)	(cam_synced[(n) >> 3] |= 1 << ((n) & 7))
+
+/* Gives the value cam_reg[i] to modify and marks its register dirty */
+static unsigned char * reg_w(int i) {
+	SET_DIRTY(i >> 1);
+	return &cam_reg[i];
+}
+
+/* Write the dirty registers with an address between start and stop.
+ * Registers with consecutive addresses are written in one burst, the
+ * camera increments the address after each byte. A register stays dirty
+ * if it couldn't be written. */
+static int write_dirty(unsigned char start, unsigned char stop) {
+	unsigned char burst[PO3030K_BURST];
+	int i, j, n;
+	int ret = 0;
+	char ok;
+
+#define TO_WRITE(n) (IS_DIRTY(n) && cam_reg[2*(n)] >= start && cam_reg[2*(n)] <= stop)
+	e_i2cp_enable();
+	for(i = 0; i < NB_REGISTERS; i += n) {
+		n = 1;
+		if(!TO_WRITE(i))
+			continue;
+		while(n < PO3030K_BURST && i + n < NB_REGISTERS && TO_WRITE(i + n) &&
+				cam_reg[2*(i + n)] == cam_reg[2*i] + n)
+			n++;
+
+		for(j = 0; j < n; j++)
+			burst[j] = cam_reg[2*(i + j) + 1];
+		if(n == 1)
+			ok = e_i2cp_write(DEVICE_ID, cam_reg[2*i], burst[0]);
+		else
+			ok = e_i2cp_write_string(DEVICE_ID, burst, cam_reg[2*i], n);
+		if(ok) {
+			for(j = 0; j < n; j++)
+				CLEAR_DIRTY(i + j);
+			ret += n;
+		}
+	}
+	e_i2cp_disable();
+#undef TO_WRITE
+
+	return ret;
+}
 
 /*! The Po3030k module keep in memory the state of each register
  * the camera has. When you configure the camera, it only alter
  * the internal register state, not the camera one.
  * This function write the internal register state in the camera.
+ * Only the registers changed since they were last written are sent.
  * \sa e_po3030k_read_cam_registers 
  */
 void e_po3030k_write_cam_registers(void) {
-	int i;
-	e_i2cp_enable();
-	for(i=0;i < 2*NB_REGISTERS; i+=2 ) 
-			e_i2cp_write(DEVICE_ID,cam_reg[i],cam_reg[i+1]);
+	while(e_po3030k_cam_registers_busy());
+	write_dirty(0x00, 0xFF);
+}
+
+static struct e_i2cq_trans cam_trans;
+
+/*! Write the internal register state in the camera without waiting.
+ * The registers from the first to the last dirty one are queued as a
+ * single I2C transaction of (register, value) pairs, sent by the I2C
+ * interrupt.
+ * \warning The values are read while they are sent, don't change the
+ * configuration before the end of the transaction.
+ * \param done Called in the I2C interrupt once the registers are written,
+ * can be NULL
+ * \sa e_po3030k_write_cam_registers, e_po3030k_cam_registers_busy
+ */
+void e_po3030k_write_cam_registers_async(void (*done)(struct e_i2cq_trans *t)) {
+	int first, last, i;
+
+	/* the transaction can't be queued twice */
+	while(e_po3030k_cam_registers_busy());
 
-	e_i2cp_disable();	
+	for(first = 0; first < NB_REGISTERS && !IS_DIRTY(first); first++);
+	for(last = NB_REGISTERS - 1; last >= first && !IS_DIRTY(last); last--);
+	for(i = first; i <= last; i++)
+		CLEAR_DIRTY(i);
+
+	cam_trans.device = DEVICE_ID;
+	cam_trans.flags = E_I2CQ_WRITE | E_I2CQ_PAIRS;
+	cam_trans.length = last - first + 1;	/* zero if nothing is dirty */
+	cam_trans.data = &cam_reg[2*first];
+	cam_trans.done = done;
+	e_i2cq_submit(&cam_trans);
+}
+
+/*! Check if the registers are being written
+ * \return Non-zero until the end of the last \a e_po3030k_write_cam_registers_async
+ */
+int e_po3030k_cam_registers_busy(void) {
+	return cam_trans.status == E_I2CQ_PENDING && e_i2cq_busy();
 }
 
 /*! Read the camera register 
+ * The internal register state is then the camera one, nothing is dirty.
  * \sa e_po3030k_write_cam_registers
  */ 
 void e_po3030k_read_cam_registers(void) {
 	int i;
+	while(e_po3030k_cam_registers_busy());
 	e_i2cp_enable();
-	for(i=0;i < 2*NB_REGISTERS; i+=2 ) 
+	for(i=0;i < 2*NB_REGISTERS; i+=2 ) {
 		cam_reg[i+1] = e_i2cp_read(DEVICE_ID,cam_reg[i]);
+		CLEAR_DIRTY(i >> 1);
+	}
 	e_i2cp_disable();
 }
 
@@ -241,13 +334,13 @@ void e_po3030k_read_cam_registers(void) {
 int e_po3030k_set_color_mode(int mode) {
 	switch (mode) {
 		case GREY_SCALE_MODE:
-			cam_reg[COLOR_M_ADDR] = MODE_GRAYSCALE;
+			*reg_w(COLOR_M_ADDR) = MODE_GRAYSCALE;
 			break;
 		case RGB_565_MODE:
-			cam_reg[COLOR_M_ADDR] = MODE_R5G6B5;
+			*reg_w(COLOR_M_ADDR) = MODE_R5G6B5;
 			break;
 		case YUV_MODE:
-			cam_reg[COLOR_M_ADDR] = MODE_YUV;
+			*reg_w(COLOR_M_ADDR) = MODE_YUV;
 			break;
 		default:
 			return -1;
@@ -265,7 +358,7 @@ int e_po3030k_set_sampling_mode(int mode) {
 	if(mode == MODE_VGA || mode == MODE_QVGA ||
 		mode == MODE_QQVGA )
 	{
-		cam_reg[SAMPLING_ADDR] = mode;
+		*reg_w(SAMPLING_ADDR) = mode;
 		return 0;
 	}
 	return -1;
@@ -284,7 +377,7 @@ int e_po3030k_set_speed(int mode) {
 		mode == SPEED_32 || mode == SPEED_64 ||
 		mode == SPEED_64 || mode == SPEED_2_3) 
 	{
-		cam_reg[SPEED_ADDR] = mode;
+		*reg_w(SPEED_ADDR) = mode;
 		return 0;
 	} 
 
@@ -309,11 +402,11 @@ int e_po3030k_set_wx(unsigned int start, unsigned int stop) {
 	stop_l = (unsigned char) stop;
 	stop_h = (unsigned char) (stop >> 8);
 
-	cam_reg[WINDOW_X1_BASE] = start_h;
-	cam_reg[WINDOW_X1_BASE + 2] = start_l;
+	*reg_w(WINDOW_X1_BASE) = start_h;
+	*reg_w(WINDOW_X1_BASE + 2) = start_l;
 	
-	cam_reg[WINDOW_X2_BASE] = stop_h;
-	cam_reg[WINDOW_X2_BASE + 2] = stop_l;
+	*reg_w(WINDOW_X2_BASE) = stop_h;
+	*reg_w(WINDOW_X2_BASE + 2) = stop_l;
 
 	return 0;
 }
@@ -336,11 +429,11 @@ int e_po3030k_set_wy(unsigned int start, unsigned int stop) {
 	stop_l = (unsigned char) stop;
 	stop_h = (unsigned char) (stop >> 8);
 
-	cam_reg[WINDOW_Y1_BASE] = start_h;
-	cam_reg[WINDOW_Y1_BASE + 2] = start_l;
+	*reg_w(WINDOW_Y1_BASE) = start_h;
+	*reg_w(WINDOW_Y1_BASE + 2) = start_l;
 	
-	cam_reg[WINDOW_Y2_BASE] = stop_h;
-	cam_reg[WINDOW_Y2_BASE + 2] = stop_l;
+	*reg_w(WINDOW_Y2_BASE) = stop_h;
+	*reg_w(WINDOW_Y2_BASE + 2) = stop_l;
 
 	return 0;
 }
@@ -368,14 +461,14 @@ int e_po3030k_set_vsync(unsigned int start,unsigned int stop,unsigned int col) {
 	col_l = (unsigned char) col;
 	col_h = (unsigned char) (col >> 8);
 
-	cam_reg[VSYNCSTART_BASE] = start_h;
-	cam_reg[VSYNCSTART_BASE + 2] = start_l;
+	*reg_w(VSYNCSTART_BASE) = start_h;
+	*reg_w(VSYNCSTART_BASE + 2) = start_l;
 	
-	cam_reg[VSYNCSTOP_BASE] = stop_h;
-	cam_reg[VSYNCSTOP_BASE + 2] = stop_l;
+	*reg_w(VSYNCSTOP_BASE) = stop_h;
+	*reg_w(VSYNCSTOP_BASE + 2) = stop_l;
 
-	cam_reg[VSYNCCOL_BASE] = col_h;
-	cam_reg[VSYNCCOL_BASE + 2] = col_l;
+	*reg_w(VSYNCCOL_BASE) = col_h;
+	*reg_w(VSYNCCOL_BASE + 2) = col_l;
 
 	return 0;
 }
@@ -401,7 +494,7 @@ void e_po3030k_set_mirror(int vertical, int horizontal) {
 			}
 		}
 	}
-	cam_reg[MIRROR_BASE] = val;
+	*reg_w(MIRROR_BASE) = val;
 }
 
 #if PO3030K_FULL
@@ -417,7 +510,7 @@ int e_po3030k_set_register(unsigned char adr,unsigned char value) {
 	int i;
 	for(i = 0; i < 2*NB_REGISTERS; i+=2) {
 		if(cam_reg[i] == adr) {
-			cam_reg[i+1] = value;
+			*reg_w(i+1) = value;
 			return 0;
 		}
 	}
@@ -449,8 +542,8 @@ int e_po3030k_get_register(unsigned char adr,unsigned char * value) {
  * \sa Datasheet p.22
  */
 void e_po3030k_set_bias(unsigned char pixbias, unsigned char opbias) {
-	cam_reg[BIAS_BASE] = opbias;
-	cam_reg[BIAS_BASE + 2] = pixbias;
+	*reg_w(BIAS_BASE) = opbias;
+	*reg_w(BIAS_BASE + 2) = pixbias;
 }
 
 /*! Set the gains of the camera
@@ -468,11 +561,11 @@ int  e_po3030k_set_color_gain(unsigned char global, unsigned char red,
 	if(global > 79)
 		return -1;
 	
-	cam_reg[COLGAIN_BASE] = global;
-	cam_reg[COLGAIN_BASE + 2] = red;
-	cam_reg[COLGAIN_BASE + 4] = green1;
-	cam_reg[COLGAIN_BASE + 6] = blue;
-	cam_reg[COLGAIN_BASE + 8] = green2;
+	*reg_w(COLGAIN_BASE) = global;
+	*reg_w(COLGAIN_BASE + 2) = red;
+	*reg_w(COLGAIN_BASE + 4) = green1;
+	*reg_w(COLGAIN_BASE + 6) = blue;
+	*reg_w(COLGAIN_BASE + 8) = green2;
 	return 0;
 }
 
@@ -482,9 +575,9 @@ int  e_po3030k_set_color_gain(unsigned char global, unsigned char red,
  * \sa Datasheet p.25
  */
 void e_po3030k_set_integr_time(unsigned long time) {
-	cam_reg[INTEGR_BASE + 2] = (unsigned char) (time >> 6);
-	cam_reg[INTEGR_BASE] = (unsigned char) (time >> 14);
-	cam_reg[INTEGR_BASE + 4] = (unsigned char) (time << 8);
+	*reg_w(INTEGR_BASE + 2) = (unsigned char) (time >> 6);
+	*reg_w(INTEGR_BASE) = (unsigned char) (time >> 14);
+	*reg_w(INTEGR_BASE + 4) = (unsigned char) (time << 8);
 }
 	
 
@@ -494,7 +587,7 @@ void e_po3030k_set_integr_time(unsigned long time) {
  * \sa Datasheet p.28
  */
 void e_po3030k_set_adc_offset(unsigned char offset) {
-	cam_reg[ADCOFF_BASE] = offset;
+	*reg_w(ADCOFF_BASE) = offset;
 }
 
 /*! Enable/Disable Sepia color
@@ -503,9 +596,9 @@ void e_po3030k_set_adc_offset(unsigned char offset) {
  */
 void e_po3030k_set_sepia(int status) {
 	if(status) 
-		cam_reg[SEPIA_BASE] |= 0b10000000;
+		*reg_w(SEPIA_BASE) |= 0b10000000;
 	else
-		cam_reg[SEPIA_BASE] &= 0b01111111;
+		*reg_w(SEPIA_BASE) &= 0b01111111;
 }  
 		
 /*! Set lens shading gain 
@@ -515,9 +608,9 @@ void e_po3030k_set_sepia(int status) {
  * \sa Datasheet p.36
  */
 void e_po3030k_set_lens_gain(unsigned char red, unsigned char green, unsigned char blue) {
-	cam_reg[LENSG_BASE] = red;
-	cam_reg[LENSG_BASE + 2] = green;
-	cam_reg[LENSG_BASE + 4] = blue;
+	*reg_w(LENSG_BASE) = red;
+	*reg_w(LENSG_BASE + 2) = green;
+	*reg_w(LENSG_BASE + 4) = blue;
 }
 
 /*! Set Edge properties 
@@ -527,8 +620,8 @@ void e_po3030k_set_lens_gain(unsigned char red, unsigned char green, unsigned ch
  */
 
 void e_po3030k_set_edge_prop(unsigned char gain, unsigned char tresh) {
-	cam_reg[EDGE_BASE] = 0b1010000 + (gain & 0b00011111);
-	cam_reg[EDGE_BASE + 2] = tresh;
+	*reg_w(EDGE_BASE) = 0b1010000 + (gain & 0b00011111);
+	*reg_w(EDGE_BASE + 2) = tresh;
 }
 
 /*! Set gamma coefficient 
@@ -542,9 +635,9 @@ void e_po3030k_set_edge_prop(unsigned char gain, unsigned char tresh) {
 
 void e_po3030k_set_gamma_coef(unsigned char array[12], char color) {
 	int i;
-	cam_reg[GAMMASELCOL_BASE] = 0b10000000 + (( color & 0x3 ) << 5);
+	*reg_w(GAMMASELCOL_BASE) = 0b10000000 + (( color & 0x3 ) << 5);
 	for(i = 0; i < sizeof(array); i++) 
-		cam_reg[GAMMA_BASE + i*2] = array[i];
+		*reg_w(GAMMA_BASE + i*2) = array[i];
 }
 
 /*! This special function write directly the Gamma coefficient and Gamma color select
@@ -555,12 +648,13 @@ void e_po3030k_set_gamma_coef(unsigned char array[12], char color) {
 
 void e_po3030k_write_gamma_coef(void) {
 	e_i2cp_enable();
-	e_i2cp_write(DEVICE_ID,cam_reg[GAMMASELCOL_BASE - 1],cam_reg[GAMMASELCOL_BASE]);
+	if(e_i2cp_write(DEVICE_ID,cam_reg[GAMMASELCOL_BASE - 1],cam_reg[GAMMASELCOL_BASE]))
+		CLEAR_DIRTY(GAMMASELCOL_BASE >> 1);
 	e_i2cp_disable();
 	e_po3030k_sync_register_array(cam_reg[GAMMA_BASE - 1], cam_reg[GAMMA_BASE + 11 * 2 - 1]);
 }
 
-/*! Write every known register between address start and stop (inclusivly).
+/*! Write every changed register between address start and stop (inclusivly).
  * \warning It's better to set the configuration with appropriate functions
  * and then write all registers with e_po3030k_WriteCamRegisters
  * \param start The beginning address of the write
@@ -570,19 +664,8 @@ void e_po3030k_write_gamma_coef(void) {
  */
 
 int  e_po3030k_sync_register_array(unsigned char start, unsigned char stop) {
-	int i;
-	int ret = 0;
-	e_i2cp_enable();
-	for(i=0;i < 2*NB_REGISTERS; i+=2 ) {
-			if(cam_reg[i] >= start && cam_reg[i] <= stop) {
-				e_i2cp_write(DEVICE_ID,cam_reg[i],cam_reg[i+1]);
-				ret++;
-			}
-	}
-
-	e_i2cp_disable();
-
-	return ret;
+	while(e_po3030k_cam_registers_busy());
+	return write_dirty(start, stop);
 }
 	
 /*! Set color correction coefficient
@@ -593,7 +676,7 @@ int  e_po3030k_sync_register_array(unsigned char start, unsigned char stop) {
 void e_po3030k_SetColorMatrix(unsigned char array[3*3]) {
 	int i;
 	for(i = 0; i< sizeof(array); i++) 
-		cam_reg[COLOR_COEF_BASE + i*2] = array[i];
+		*reg_w(COLOR_COEF_BASE + i*2) = array[i];
 }
 
 /*! Set The color gain ( Cb/Cr )
@@ -603,8 +686,8 @@ void e_po3030k_SetColorMatrix(unsigned char array[3*3]) {
  */
 
 void e_po3030k_set_cb_cr_gain(unsigned char cg11c, unsigned char cg22c) {	
-	cam_reg[CBCRGAIN_BASE] = cg11c;
-	cam_reg[CBCRGAIN_BASE + 2] = cg22c;
+	*reg_w(CBCRGAIN_BASE) = cg11c;
+	*reg_w(CBCRGAIN_BASE + 2) = cg22c;
 }
 
 /*! Set the Brightness & Contrast
@@ -614,8 +697,8 @@ void e_po3030k_set_cb_cr_gain(unsigned char cg11c, unsigned char cg22c) {
  */
 
 void e_po3030k_set_brigh_contr(unsigned char bright, unsigned char contrast) {	
-	cam_reg[BRICTR_BASE] = bright;
-	cam_reg[BRICTR_BASE + 2] = contrast;
+	*reg_w(BRICTR_BASE) = bright;
+	*reg_w(BRICTR_BASE + 2) = contrast;
 }
 
 /*! Set The color tone at sepia color condition
@@ -625,8 +708,8 @@ void e_po3030k_set_brigh_contr(unsigned char bright, unsigned char contrast) {
  */
 
 void e_po3030k_set_sepia_tone(unsigned char cb, unsigned char cr) {
-	cam_reg[SEPIATONE_BASE] = cb;
-	cam_reg[SEPIATONE_BASE + 2] = cr;
+	*reg_w(SEPIATONE_BASE) = cb;
+	*reg_w(SEPIATONE_BASE + 2) = cr;
 }
 
 /*! Set the Center weight (Back Light compensation) Control parameter 
@@ -635,7 +718,7 @@ void e_po3030k_set_sepia_tone(unsigned char cb, unsigned char cr) {
  */
 
 void e_po3030k_set_ww(unsigned char ww) { 
-	cam_reg[WW_BASE] = (ww << 4) + 0b1111;
+	*reg_w(WW_BASE) = (ww << 4) + 0b1111;
 }
 
 /*! Set AWB/AE tolerence margin
@@ -645,7 +728,7 @@ void e_po3030k_set_ww(unsigned char ww) {
  */
 
 void e_po3030k_set_awb_ae_tol(unsigned char awbm, unsigned char aem) {
-	cam_reg[AWVAETOL_BASE] = (awbm << 4) + (aem & 0b1111);
+	*reg_w(AWVAETOL_BASE) = (awbm << 4) + (aem & 0b1111);
 }
 
 /*! Set AE speed 
@@ -655,7 +738,7 @@ void e_po3030k_set_awb_ae_tol(unsigned char awbm, unsigned char aem) {
  */
 
 void e_po3030k_set_ae_speed(unsigned char b, unsigned char d) {
-	cam_reg[AESPEED_BASE] = (d << 4) + (b & 0b1111);
+	*reg_w(AESPEED_BASE) = (d << 4) + (b & 0b1111);
 }
 
 /*! Set exposure time 
@@ -665,9 +748,9 @@ void e_po3030k_set_ae_speed(unsigned char b, unsigned char d) {
  */
 
 void e_po3030k_set_exposure(long t) {
-	cam_reg[EXPOSURE_BASE] = (unsigned char) (t >> 16);
-	cam_reg[EXPOSURE_BASE + 2] = (unsigned char) (t >> 8);
-	cam_reg[EXPOSURE_BASE + 4] = (unsigned char ) t;
+	*reg_w(EXPOSURE_BASE) = (unsigned char) (t >> 16);
+	*reg_w(EXPOSURE_BASE + 2) = (unsigned char) (t >> 8);
+	*reg_w(EXPOSURE_BASE + 4) = (unsigned char ) t;
 }
 
 /*! Set the reference exposure. The average brightness which the AE should have
@@ -676,7 +759,7 @@ void e_po3030k_set_exposure(long t) {
  */
 
 void e_po3030k_set_ref_exposure(unsigned char exp) {
-	cam_reg[REFREPO_BASE] = exp;
+	*reg_w(REFREPO_BASE) = exp;
 }
 
 /*! Set the minimum and maximum exposure time in AE mode
@@ -686,10 +769,10 @@ void e_po3030k_set_ref_exposure(unsigned char exp) {
  */
 
 void e_po3030k_set_max_min_exp(unsigned int max, unsigned int min) {
-	cam_reg[MINMAXEXP_BASE] = (unsigned char) (max >> 8);
-	cam_reg[MINMAXEXP_BASE + 2] = (unsigned char) max;
-	cam_reg[MINMAXEXP_BASE + 4] = (unsigned char) (min >> 8);
-	cam_reg[MINMAXEXP_BASE + 6] = (unsigned char) min;
+	*reg_w(MINMAXEXP_BASE) = (unsigned char) (max >> 8);
+	*reg_w(MINMAXEXP_BASE + 2) = (unsigned char) max;
+	*reg_w(MINMAXEXP_BASE + 4) = (unsigned char) (min >> 8);
+	*reg_w(MINMAXEXP_BASE + 6) = (unsigned char) min;
 }
 
 /*! Set the minimum and maximum red and blue gain in AWB mode
@@ -703,13 +786,13 @@ void e_po3030k_set_max_min_exp(unsigned int max, unsigned int min) {
  */
 void e_po3030k_set_max_min_awb(unsigned char minb, unsigned char maxb, unsigned char minr,
 					unsigned char maxr, unsigned char ratior, unsigned char ratiob) {
-	cam_reg[MINMAXAWB_BASE] = minr;
-	cam_reg[MINMAXAWB_BASE + 2] = maxr;
-	cam_reg[MINMAXAWB_BASE + 4] = minb;
-	cam_reg[MINMAXAWB_BASE + 6] = maxb;
+	*reg_w(MINMAXAWB_BASE) = minr;
+	*reg_w(MINMAXAWB_BASE + 2) = maxr;
+	*reg_w(MINMAXAWB_BASE + 4) = minb;
+	*reg_w(MINMAXAWB_BASE + 6) = maxb;
 
-	cam_reg[MINMAXAWB_BASE + 8] = ratior;
-	cam_reg[MINMAXAWB_BASE + 10] = ratiob;
+	*reg_w(MINMAXAWB_BASE + 8) = ratior;
+	*reg_w(MINMAXAWB_BASE + 10) = ratiob;
 }
 
 /*! Set the Weighting Window coordinate
@@ -737,15 +820,15 @@ int  e_po3030k_set_weight_win(unsigned int x1, unsigned int x2, unsigned int y1,
 	if(x1 <= 421 || x2 >= 634 || y1 <= 167 || y2 >= 327)
 		return -1;
 
-	cam_reg[WEIGHWIN_BASE] = (unsigned char) (x1 >> 8);
-	cam_reg[WEIGHWIN_BASE + 2] = (unsigned char) x1;
-	cam_reg[WEIGHWIN_BASE + 4] = (unsigned char) (x2 >> 8);
-	cam_reg[WEIGHWIN_BASE + 6] = (unsigned char) x2;
+	*reg_w(WEIGHWIN_BASE) = (unsigned char) (x1 >> 8);
+	*reg_w(WEIGHWIN_BASE + 2) = (unsigned char) x1;
+	*reg_w(WEIGHWIN_BASE + 4) = (unsigned char) (x2 >> 8);
+	*reg_w(WEIGHWIN_BASE + 6) = (unsigned char) x2;
 	
-	cam_reg[WEIGHWIN_BASE + 8] = (unsigned char) (y1 >> 8);
-	cam_reg[WEIGHWIN_BASE + 10] = (unsigned char) y1;
-	cam_reg[WEIGHWIN_BASE + 12] = (unsigned char) (y2 >> 8);
-	cam_reg[WEIGHWIN_BASE + 14] = (unsigned char) y2;
+	*reg_w(WEIGHWIN_BASE + 8) = (unsigned char) (y1 >> 8);
+	*reg_w(WEIGHWIN_BASE + 10) = (unsigned char) y1;
+	*reg_w(WEIGHWIN_BASE + 12) = (unsigned char) (y2 >> 8);
+	*reg_w(WEIGHWIN_BASE + 14) = (unsigned char) y2;
 	return 0;
 }
 
@@ -770,7 +853,7 @@ void e_po3030k_set_awb_ae(int awb, int ae) {
 			}
 		}
 	}
-	cam_reg[AWBAEENABLE_BASE] = val;
+	*reg_w(AWBAEENABLE_BASE) = val;
 }
 
 /*! Set flicker detection mode
@@ -780,9 +863,9 @@ void e_po3030k_set_awb_ae(int awb, int ae) {
 
 void e_po3030k_set_flicker_mode(int manual) {
 	if(manual) {
-		cam_reg[FLICKM_BASE] &= ~0x80;
+		*reg_w(FLICKM_BASE) &= ~0x80;
 	} else {
-		cam_reg[FLICKM_BASE] |= 0x80;
+		*reg_w(FLICKM_BASE) |= 0x80;
 	}
 }
 
@@ -798,15 +881,15 @@ void e_po3030k_set_flicker_mode(int manual) {
 void e_po3030k_set_flicker_detection(int hz50, int hz60) {
 
 	if(hz50) {
-		cam_reg[FLICKM_BASE] &= ~0x40;
+		*reg_w(FLICKM_BASE) &= ~0x40;
 	} else {
-		cam_reg[FLICKM_BASE] |= 0x40;
+		*reg_w(FLICKM_BASE) |= 0x40;
 	}
 
 	if(hz60) {
-		cam_reg[FLICKM_BASE] &= ~0x20;
+		*reg_w(FLICKM_BASE) &= ~0x20;
 	} else {
-		cam_reg[FLICKM_BASE] |= 0x20;
+		*reg_w(FLICKM_BASE) |= 0x20;
 	}
 
 }
@@ -878,19 +961,21 @@ int  e_po3030k_set_flicker_man_set(int hz50, int hz60, int fdm, int fk, int tol)
 	p50 = ( po3030k_get_pixelclock() * 2 * FRAME_WIDTH) / (long) hz50;
 	p60 = ( po3030k_get_pixelclock() * 2 * FRAME_WIDTH) / (long) hz60;
 	
-	cam_reg[FLICKP_BASE] = (unsigned char) (p50 >> 8);
-	cam_reg[FLICKP_BASE + 2] = (unsigned char) p50;
-	cam_reg[FLICKP_BASE + 4] = (unsigned char) (p60 >> 8);
-	cam_reg[FLICKP_BASE + 6] = (unsigned char) p60;
+	*reg_w(FLICKP_BASE) = (unsigned char) (p50 >> 8);
+	*reg_w(FLICKP_BASE + 2) = (unsigned char) p50;
+	*reg_w(FLICKP_BASE + 4) = (unsigned char) (p60 >> 8);
+	*reg_w(FLICKP_BASE + 6) = (unsigned char) p60;
 
 	if(fdm) {
-		cam_reg[FLICKM_BASE] |= 0x10;
+		*reg_w(FLICKM_BASE) |= 0x10;
 	} else {
-		cam_reg[FLICKM_BASE] &= ~0x10;
+		*reg_w(FLICKM_BASE) &= ~0x10;
 	}
 
-	cam_reg[FLICKM_BASE] = (tol & 0x3) + ((fk & 0x3) << 2) + (cam_reg[FLICKM_BASE] & 0xF0);
+	*reg_w(FLICKM_BASE) = (tol & 0x3) + ((fk & 0x3) << 2) + (cam_reg[FLICKM_BASE] & 0xF0);
 
 	return 0;
 }
 #endif
+
+#endif /* POXXXX_SENSOR */
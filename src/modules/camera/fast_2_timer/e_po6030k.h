@@ -39,6 +39,8 @@ int  e_po6030k_get_bytes_per_pixel(int color_mode);
 void e_po6030k_set_color_mode(unsigned char format);
 
 void e_po6030k_set_bank(unsigned char bank);
+
+void e_po6030k_forget_bank(void);
 void e_po6030k_write_register(unsigned char bank, unsigned char reg, unsigned char value);
 #define e_po6030k_set_speed(div) e_po6030k_set_bayer_clkdiv(div)
 void e_po6030k_set_bayer_clkdiv(unsigned char div);
@@ -9,6 +9,9 @@
 #include "../../I2C/e_I2C_protocol.h"
 #include "e_po6030k.h"
 
+/* not built for the other sensor, see POXXXX_SENSOR */
+#if POXXXX_SENSOR != POXXXX_PO3030K
+
 #define MCLK				((long) 14745600)  /* 14.7456Mhz */
 #define MCLK_P_NS			0.067816840278 /* Master clock period in ns */
 
@@ -21,16 +24,32 @@
 #define DEVICE_ID 0xDC
 #define BANK_REGISTER 0x3
 
+/* The bank selected in the camera, -1 if unknown */
+static int current_bank = -1;
+
 /*! Set the camera register bank to use 
+ * The bank is only written if it isn't the selected one already.
  * \param bank The bank used.
  * \sa BANK_A, BANK_B, BANK_C, BANK_D
  */
 void e_po6030k_set_bank(unsigned char bank) {
+	if(current_bank == bank)
+		return;
 	e_i2cp_enable();
-	e_i2cp_write(DEVICE_ID, BANK_REGISTER, bank);
+	if(e_i2cp_write(DEVICE_ID, BANK_REGISTER, bank))
+		current_bank = bank;
+	else
+		current_bank = -1;
 	e_i2cp_disable();
 }
 
+/*! Forget the selected bank, after a reset of the camera
+ * \sa e_po6030k_set_bank
+ */
+void e_po6030k_forget_bank(void) {
+	current_bank = -1;
+}
+
 /*! Set the register reg to value
  * \param bank The register bank
  * \param reg The register address
@@ -271,3 +290,4 @@ void e_po6030k_set_mirror(int vertical, int horizontal) {
 	e_po6030k_write_register(BANK_A, 0x90, bc);
 }
 
+#endif /* POXXXX_SENSOR */
@@ -19,6 +19,18 @@
  * But you loose all advanced camera functions */
 #define POXXXX_FULL		1
 
+#define POXXXX_AUTO		0	/*!< The sensor is read at startup */
+#define POXXXX_PO3030K		0x3030
+#define POXXXX_PO6030K		0x6030
+
+/*! The sensor the driver is built for. With \ref POXXXX_AUTO both drivers
+ * are built and the version is read by \a e_poxxxx_init_cam. With a fixed
+ * sensor the e_poxxxx functions call its driver directly and the other
+ * driver is left out, the po3030k one holds its registers in RAM. */
+#ifndef POXXXX_SENSOR
+#define POXXXX_SENSOR		POXXXX_AUTO
+#endif
+
 #define	ARRAY_WIDTH		640
 #define	ARRAY_HEIGHT		480
 
@@ -33,12 +45,24 @@ int e_poxxxx_config_cam(unsigned int sensor_x1,unsigned int sensor_y1,
 
 void e_poxxxx_init_cam(void);
 
+void e_poxxxx_sleep_cam(void);
+
+void e_poxxxx_wake_cam(void);
+
 void e_poxxxx_write_cam_registers(void);
 
+void e_poxxxx_write_cam_registers_async(void);
+
+int  e_poxxxx_cam_registers_busy(void);
+
 void e_poxxxx_launch_capture(char * buf);
 
 int  e_poxxxx_is_img_ready(void);
 
+int  e_poxxxx_rows_done(void);
+
+int  e_poxxxx_rows_total(void);
+
 void e_poxxxx_set_mirror(int vertical, int horizontal);
 
 int e_poxxxx_apply_timer_config(int pixel_row, int pixel_col, int bpp, int pbp, int bbl);
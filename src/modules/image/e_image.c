@@ -0,0 +1,86 @@
+/*! \file
+ * \ingroup image
+ * \brief Image processing on the e-puck.
+ * \author Code: Darius Kellermann
+ */
+
+#include "e_image.h"
+
+/*! \brief Make a thumbnail of an image
+ *
+ * Each pixel of the thumbnail is the mean of a block of factor x factor
+ * pixels. The rows and columns that don't fill a block are ignored.
+ * \param img The image
+ * \param width The number of columns
+ * \param height The number of rows
+ * \param factor The size of the blocks, at most 16
+ * \param thumb The thumbnail, (width / factor) x (height / factor) bytes
+ * \param work An array of width values, used for the sums
+ */
+void e_img_bin(const char *img, int width, int height, int factor,
+		char *thumb, unsigned int *work)
+{
+	int band, x, i;
+	unsigned int sum, area = factor * factor;
+
+	for (band = 0; band < height / factor; band++)
+	{
+		e_img_col_sum(img + band * factor * width, width, factor, work);
+		for (x = 0; x + factor <= width; x += factor)
+		{
+			sum = 0;
+			for (i = 0; i < factor; i++)
+				sum += work[x + i];
+			*thumb++ = sum / area;
+		}
+	}
+}
+
+/*! \brief Find the centroid of the pixels at or above a threshold
+ * \param img The image
+ * \param width The number of columns, at most 2047
+ * \param height The number of rows, at most 2047
+ * \param thr The threshold
+ * \param blob The result
+ * \param work An array of max(width, height) values
+ */
+void e_img_blob(const char *img, int width, int height, unsigned int thr,
+		struct e_img_blob *blob, int *work)
+{
+	long count, moment;
+
+	e_img_col_count(img, width, height, thr, work);
+	moment = e_img_moment(work, width, &count);
+	blob->count = count;
+	if (count == 0)
+	{
+		blob->x = blob->y = -1;
+		return;
+	}
+	blob->x = (moment * 16 + count / 2) / count;
+
+	e_img_row_count(img, width, height, thr, work);
+	moment = e_img_moment(work, height, &count);
+	blob->y = (moment * 16 + count / 2) / count;
+}
+
+/*! \brief Pack an RGB565 image to RGB332, in place
+ *
+ * The camera sends each pixel as RRRRRGGG GGGBBBBB, the packed pixel is
+ * RRRGGGBB. The packed image takes the first half of the buffer.
+ * \param img The image, 2 * pixels bytes
+ * \param pixels The number of pixels
+ */
+void e_img_pack_rgb332(char *img, int pixels)
+{
+	const unsigned char *src = (const unsigned char *)img;
+	unsigned char *dst = (unsigned char *)img;
+	unsigned char hi, lo;
+
+	while (pixels-- > 0)
+	{
+		hi = *src++;
+		lo = *src++;
+		*dst++ = (hi & 0xE0) | ((hi & 0x07) << 2) | ((lo >> 3) & 0x03);
+	}
+}
@@ -0,0 +1,81 @@
+/*! \file
+ * \ingroup image
+ * \brief Image processing on the e-puck.
+ *
+ * The functions work on grayscale images as captured by the camera: arrays
+ * of unsigned bytes, one row after the other. Their results are small enough
+ * to be sent at the frame rate of the camera. \ref e_img_pack_rgb332 works
+ * on RGB565 images.
+ * \author Code: Darius Kellermann
+ */
+
+/*! \defgroup image Image processing
+ *
+ * \section intro_sec Introduction
+ * This package reduces a captured image to a few values:
+ * - a column profile (\ref e_img_col_sum),
+ * - a binned thumbnail (\ref e_img_bin),
+ * - the position of a bright blob (\ref e_img_blob),
+ * - a colour image with one byte per pixel (\ref e_img_pack_rgb332).
+ *
+ * \warning The loops are written in ASM in "e_image_kernels.S", they use
+ * the DO hardware loop and the DSP accumulators. Don't call them from an
+ * interrupt.
+ * \author Doc: Darius Kellermann
+ */
+
+#ifndef _IMAGE
+#define _IMAGE
+
+/*! \brief The position of a blob, as given by \ref e_img_blob */
+struct e_img_blob {
+	unsigned int count;	/*!< Pixels above the threshold, 0 if none */
+	int x;			/*!< Column of the centroid, in 1/16 pixel */
+	int y;			/*!< Row of the centroid, in 1/16 pixel */
+};
+
+/*! \brief Sum each column of an image
+ * \param img The image
+ * \param width The number of columns
+ * \param height The number of rows, at most 257 so that the sums fit
+ * \param sums The array of width sums
+ */
+void e_img_col_sum(const char *img, int width, int height, unsigned int *sums);
+
+/*! \brief Count in each column the pixels at or above a threshold
+ * \param img The image
+ * \param width The number of columns
+ * \param height The number of rows
+ * \param thr The threshold
+ * \param counts The array of width counts
+ */
+void e_img_col_count(const char *img, int width, int height,
+		unsigned int thr, int *counts);
+
+/*! \brief Count in each row the pixels at or above a threshold
+ * \param img The image
+ * \param width The number of columns
+ * \param height The number of rows
+ * \param thr The threshold
+ * \param counts The array of height counts
+ */
+void e_img_row_count(const char *img, int width, int height,
+		unsigned int thr, int *counts);
+
+/*! \brief The first moment of an array
+ * \param v The array
+ * \param n The length of the array
+ * \param sum Where to store the sum of v[i]
+ * \return The sum of i * v[i]
+ */
+long e_img_moment(const int *v, int n, long *sum);
+
+void e_img_bin(const char *img, int width, int height, int factor,
+		char *thumb, unsigned int *work);
+
+void e_img_blob(const char *img, int width, int height, unsigned int thr,
+		struct e_img_blob *blob, int *work);
+
+void e_img_pack_rgb332(char *img, int pixels);
+
+#endif
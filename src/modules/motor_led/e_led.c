@@ -45,6 +45,34 @@ EPFL Ecole polytechnique federale de Lausanne http://www.epfl.ch
 #include "e_epuck_ports.h"
 #include "e_led.h"
 
+#define LED_BITS	0xF6C0	// the LATA bits of the 8 LEDs
+
+// LATA bits of the LEDs 0-3 and 4-7, for each nibble of a mask
+static const unsigned int led_bits_lo[16] = {
+	0x0000, 0x0040, 0x0080, 0x00C0, 0x0200, 0x0240, 0x0280, 0x02C0,
+	0x1000, 0x1040, 0x1080, 0x10C0, 0x1200, 0x1240, 0x1280, 0x12C0
+};
+static const unsigned int led_bits_hi[16] = {
+	0x0000, 0x0400, 0x2000, 0x2400, 0x4000, 0x4400, 0x6000, 0x6400,
+	0x8000, 0x8400, 0xA000, 0xA400, 0xC000, 0xC400, 0xE000, 0xE400
+};
+
+static volatile unsigned int led_mask = 0;	// mask of e_set_led_mask
+static volatile unsigned int led_level = E_LED_DIM_STEPS;
+static unsigned int led_phase = 0;		// tick of the dimming period
+
+/* set the LEDs to the given LATA bits, the port is only written on a change */
+static void write_leds(unsigned int bits)
+{
+	if ((LATA & LED_BITS) != bits)
+		LATA = (LATA & ~LED_BITS) | bits;
+}
+
+static unsigned int mask_bits(unsigned int mask)
+{
+	return led_bits_lo[mask & 0xF] | led_bits_hi[(mask >> 4) & 0xF];
+}
+
 /*! \brief turn on/off the specified LED
  *
  * The e-puck has 8 green LEDs. With this function, you can
@@ -56,81 +84,14 @@ EPFL Ecole polytechnique federale de Lausanne http://www.epfl.ch
  */
 void e_set_led(unsigned int led_number, unsigned int value)
 {
-	switch(led_number)
-	{
-		case 0: 
-			{
-			if(value>1)
-				LED0 = LED0^1; // "^" exclusif OR bit to bit
-			else
-				LED0 = value;
-			break;
-			}
-		case 1: 
-			{
-			if(value>1)
-				LED1 = LED1^1;
-			else
-				LED1 = value;
-			break;
-			}
-		case 2: 
-			{
-			if(value>1)
-				LED2 = LED2^1;
-			else
-				LED2 = value;
-			break;
-			}
-		case 3: 
-			{
-			if(value>1)
-				LED3 = LED3^1;
-			else
-				LED3 = value;
-			break;
-			}
-		case 4: 
-			{
-			if(value>1)
-				LED4 = LED4^1;
-			else
-				LED4 = value;
-			break;
-			}
-		case 5: 
-			{
-			if(value>1)
-				LED5 = LED5^1;
-			else
-				LED5 = value;
-			break;
-			}
-		case 6: 
-			{
-			if(value>1)
-				LED6 = LED6^1;
-			else
-				LED6 = value;
-			break;
-			}
-		case 7: 
-			{
-			if(value>1)
-				LED7 = LED7^1;
-			else
-				LED7 = value;
-			break;
-			}
-		default:
-			if(value > 1)
-			{
-				LED0 = LED0^1; LED1 = LED1^1; LED2 = LED2^1; LED3 = LED3^1;
-				LED4 = LED4^1; LED5 = LED5^1; LED6 = LED6^1; LED7 = LED7^1;
-			}	
-			else
-				LED0 = LED1 = LED2 = LED3 = LED4 = LED5 = LED6 = LED7 = value;
-	}
+	unsigned int bits = (led_number < 8) ? mask_bits(1 << led_number) : LED_BITS;
+
+	if(value>1)
+		LATA ^= bits; // "^" exclusif OR bit to bit
+	else if(value)
+		LATA |= bits;
+	else
+		LATA &= ~bits;
 }
 
 /*! \brief turn on/off the body LED
@@ -161,6 +122,58 @@ void e_set_front_led(unsigned int value)
 	FRONT_LED = value;
 }
 
+/*! \brief Set the 8 LEDs at once
+ *
+ * The LEDs are set with one write of LATA, only if they change. While
+ * they are dimmed, they are set at the start of the next period.
+ * \param mask Bit i is the state of LED i, 0 to 7
+ * \sa e_set_led_dim
+ */
+void e_set_led_mask(unsigned int mask)
+{
+	led_mask = mask & 0xFF;
+	if (led_level >= E_LED_DIM_STEPS)
+		write_leds(mask_bits(led_mask));
+}
+
+/*! \brief Give the 8 LEDs as a mask
+ * \return The mask of the last \ref e_set_led_mask
+ */
+unsigned int e_get_led_mask(void)
+{
+	return led_mask;
+}
+
+/*! \brief Dim the LEDs set by \ref e_set_led_mask
+ *
+ * The LEDs are lit during \a level ticks of each period of
+ * \ref E_LED_DIM_STEPS ticks, see \ref e_led_tick.
+ * \param level From 0 (off) to \ref E_LED_DIM_STEPS (always on)
+ */
+void e_set_led_dim(unsigned int level)
+{
+	led_level = (level > E_LED_DIM_STEPS) ? E_LED_DIM_STEPS : level;
+	if (led_level >= E_LED_DIM_STEPS)
+		write_leds(mask_bits(led_mask));
+}
+
+/*! \brief Advance the dimming by one tick
+ *
+ * To be called from a periodic interrupt, e.g. every ms for a period of
+ * 8 ms. The port is only written at the two edges of the pulse.
+ */
+void e_led_tick(void)
+{
+	if (led_level >= E_LED_DIM_STEPS)
+		return;
+	if (++led_phase >= E_LED_DIM_STEPS)
+		led_phase = 0;
+	if (led_phase == 0)
+		write_leds((led_level > 0) ? mask_bits(led_mask) : 0);
+	else if (led_phase == led_level)
+		write_leds(0);
+}
+
 /*! \brief turn off the 8 LEDs
  *
  * The e-puck has 8 green LEDs. This function turn all off.
@@ -168,12 +181,5 @@ void e_set_front_led(unsigned int value)
  */
 void e_led_clear(void)
 {
-	LED0 = 0;
-	LED1 = 0;
-	LED2 = 0;
-	LED3 = 0;
-	LED4 = 0;
-	LED5 = 0;
-	LED6 = 0;
-	LED7 = 0;
+	LATA &= ~LED_BITS;
 }
@@ -52,5 +52,12 @@ void e_led_clear(void);
 void e_set_body_led(unsigned int value); // value (0=off 1=on higher=inverse) 
 void e_set_front_led(unsigned int value); //value (0=off 1=on higher=inverse) 
 
+#define E_LED_DIM_STEPS	8	// ticks of a dimming period
+
+void e_set_led_mask(unsigned int mask);	// bit i (0-7) sets LED i
+unsigned int e_get_led_mask(void);	// the mask of the LEDs that are lit
+void e_set_led_dim(unsigned int level);	// 0 (off) to E_LED_DIM_STEPS (on)
+void e_led_tick(void);			// dimming, from a periodic interrupt
+
 #endif
 
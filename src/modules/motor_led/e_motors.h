@@ -50,6 +50,11 @@ EPFL Ecole polytechnique federale de Lausanne http://www.epfl.ch
 #ifndef _MOTORS
 #define _MOTORS
 
+// with timer3, the speeds are ramped with this default acceleration
+#define E_MOTOR_ACCEL		3000	// steps/s^2
+// the speed at which the moves end
+#define E_MOTOR_MIN_SPEED	50	// steps/s
+
 /* functions */
 
 void e_init_motors(void); // init to be done before using the other calls
@@ -60,4 +65,12 @@ int e_get_steps_left(void);					// motors steps done left
 int e_get_steps_right(void);				// motors steps done right
 void e_set_steps_left(int set_steps);		// set motor steps counter
 void e_set_steps_right(int set_steps);		// set motor steps counter
+
+/* timer3 only */
+void e_move_left(int steps, int motor_speed);	// steps to make, non blocking
+void e_move_right(int steps, int motor_speed);	// steps to make, non blocking
+int e_motors_moving(void);			// a move is in progress
+int e_motors_running(void);			// a wheel turns
+void e_get_steps_long(long *left, long *right);	// 32 bit steps of both
+void e_set_acceleration(int steps_s2);		// ramp of the speeds
 #endif
@@ -37,150 +37,214 @@ EPFL Ecole polytechnique federale de Lausanne http://www.epfl.ch
 #include <stdlib.h>
 #include "e_epuck_ports.h"
 #include "e_init_port.h"
+#include "e_motors.h"
+#include "../profile/e_profile.h"
 
 /* internal variables */
 
-static int left_speed = 0;
-static int right_speed = 0;
+/*
+ * Timer3 counts at FCY/8 and interrupts at the next event only: the next
+ * step of a wheel or the next ramp of the speeds, every ms. The timer is
+ * stopped when both wheels are stopped.
+ */
+#define CNT_PER_S	((unsigned long)(FCY / 8))	// Timer3 counts per s
+#define CNT_PER_RAMP	((unsigned int)(CNT_PER_S / 1000))	// ramp every ms
+#define CNT_MIN		64		// shortest period, the ISR must fit in
+#define SPEED_FRAC	4		// the current speeds are in 1/16 steps/s
+
+struct wheel {
+	int target;		// speed to reach in steps/s
+	int speed;		// current speed in 1/16 steps/s
+	unsigned long phase;	// a step is made each CNT_PER_S
+	int remaining;		// steps left to the end of the move, -1 if none
+	int phase_nb;		// phase of the coils, 0 to 3
+};
+
+static struct wheel left = {0, 0, 0, -1, 0};
+static struct wheel right = {0, 0, 0, -1, 0};
+
 static int nbr_pas_left = 0;
 static int nbr_pas_right = 0;
+static long steps_left = 0;	// same as nbr_pas_*, they don't wrap
+static long steps_right = 0;
+
+static int accel = E_MOTOR_ACCEL;	// in steps/s^2, 0 for no ramp
+static int accel_inc = (E_MOTOR_ACCEL * (1L << SPEED_FRAC)) / 1000;	// per ramp
 
-static int motor_counter_left =0;
-static int motor_counter_right=0;
-static int motor_counter_left_init =0;
-static int motor_counter_right_init=0;
+static unsigned int period = CNT_PER_RAMP;	// counts of the running period
+static unsigned int to_ramp = CNT_PER_RAMP;	// counts to the next ramp
+
+// coil patterns of the phases 0 to 3, PHA in bit 0 to PHD in bit 3
+static const unsigned char coils[4] = {0xA, 0x6, 0x5, 0x9};
 
 /* internal calls */
- 
-void __attribute__((interrupt, auto_psv, shadow))
+
+/* bring the speed of a wheel towards its target */
+static void ramp(struct wheel *w)
+{
+	int target = w->target * (1 << SPEED_FRAC);
+	int v;
+
+	if (w->remaining > 0 && accel != 0)
+	{
+		// brake as late as possible: v^2 >= 2 * a * d
+		v = abs(w->speed) >> SPEED_FRAC;
+		if ((long)v * v >= 2L * accel * w->remaining)
+		{
+			v = abs(w->target) < E_MOTOR_MIN_SPEED ? abs(w->target) : E_MOTOR_MIN_SPEED;
+			target = (w->target < 0 ? -v : v) * (1 << SPEED_FRAC);
+		}
+	}
+
+	if (accel == 0)
+		w->speed = target;
+	else if (w->speed < target)
+		w->speed = (target - w->speed > accel_inc) ? w->speed + accel_inc : target;
+	else if (w->speed > target)
+		w->speed = (w->speed - target > accel_inc) ? w->speed - accel_inc : target;
+}
+
+/* advance the phase of a wheel by cnt counts, returns the direction of the
+ * step to make */
+static int advance(struct wheel *w, unsigned int cnt)
+{
+	int dir = w->speed > 0 ? 1 : -1;
+
+	if (w->speed == 0)
+		return 0;
+	w->phase += __builtin_muluu(abs(w->speed) >> SPEED_FRAC, cnt);
+	if (w->phase < CNT_PER_S)
+		return 0;
+	w->phase -= CNT_PER_S;
+	if (w->remaining > 0 && --w->remaining == 0)
+	{
+		// end of the move, stop at once
+		w->remaining = -1;
+		w->target = 0;
+		w->speed = 0;
+	}
+	return dir;
+}
+
+/* shorten cnt to the next step of a wheel, if it comes before */
+static unsigned int next_step(struct wheel *w, unsigned int cnt)
+{
+	unsigned int v = abs(w->speed) >> SPEED_FRAC;
+	unsigned long left_phase = CNT_PER_S - w->phase;
+
+	// the quotient is below cnt, so it fits the 32/16 division
+	if (v == 0 || left_phase >= __builtin_muluu(v, cnt))
+		return cnt;
+	return __builtin_divud(left_phase + v - 1, v);
+}
+
+static int wheel_idle(struct wheel *w)
+{
+	return w->speed == 0 && w->target == 0;
+}
+
+/* start the timer if it sleeps, the next event is a ramp */
+static void wake_up(void)
+{
+	if (T3CONbits.TON)
+		return;
+	period = to_ramp = CNT_PER_RAMP;
+	TMR3 = 0;
+	PR3 = period - 1;
+	T3CONbits.TON = 1;
+}
+
+// no shadow registers, the camera interrupt uses them and nests into this one
+void __attribute__((interrupt, auto_psv))
  _T3Interrupt(void) // interrupt for motor
 {
-  static int motor_phase_left=0;		 // phase can be 0 to 3
-  static int motor_phase_right=0;
+  int dir;
+  unsigned int coil = LATD & 0xFF00;
+  E_PROF_ENTER();
+  E_PROF_LATENCY(E_PROF_LAT_T3, TMR3 << 3);	// Timer3 counts at FCY/8
 
   IFS0bits.T3IF = 0;             // clear interrupt flag
 
-
-  if (left_speed != 0)
-  	motor_counter_left--;
-  else
+  // the period that just ended
+  dir = advance(&left, period);
+  if (dir > 0) // inverted for the two motors
+  {
+	nbr_pas_left++;
+	steps_left++;
+	if (--left.phase_nb < 0) left.phase_nb = 3;
+  }
+  else if (dir < 0)
   {
-    MOTOR1_PHA = 0;
-    MOTOR1_PHB = 0;
-    MOTOR1_PHC = 0;
-    MOTOR1_PHD = 0;
+	nbr_pas_left--;
+	steps_left--;
+	if (++left.phase_nb > 3) left.phase_nb = 0;
   }
-  if (right_speed != 0)
-  	motor_counter_right--;
-  else
+  dir = advance(&right, period);
+  if (dir < 0)
   {
-    MOTOR2_PHA = 0;
-    MOTOR2_PHB = 0;
-    MOTOR2_PHC = 0;
-    MOTOR2_PHD = 0;
+	nbr_pas_right--;
+	steps_right--;
+	if (--right.phase_nb < 0) right.phase_nb = 3;
+  }
+  else if (dir > 0)
+  {
+	nbr_pas_right++;
+	steps_right++;
+	if (++right.phase_nb > 3) right.phase_nb = 0;
   }
 
-  if (motor_counter_left <= 0) 
+  to_ramp -= period;
+  if (to_ramp == 0)
   {
-	motor_counter_left=motor_counter_left_init;  
-
-  	// increment or decrement phase depending on direction
-
-  	if (left_speed > 0) // inverted for the two motors
-    {
-    	nbr_pas_left++;
-		motor_phase_left--;
-    	if (motor_phase_left < 0) motor_phase_left = 3;
-    }
-  	else 
-    {
-    	nbr_pas_left--;
-    	motor_phase_left++;
-    if (motor_phase_left > 3) motor_phase_left = 0;
-    }
-  
-  	// set the phase on the port pins
-
- 	switch (motor_phase_left)
-  	{
-    case 0:
-      MOTOR1_PHA = 0;
-      MOTOR1_PHB = 1;
-      MOTOR1_PHC = 0;
-      MOTOR1_PHD = 1;
-      break;
-    case 1:
-      MOTOR1_PHA = 0;
-      MOTOR1_PHB = 1;
-      MOTOR1_PHC = 1;
-      MOTOR1_PHD = 0;
-      break;
-    case 2:
-      MOTOR1_PHA = 1;
-      MOTOR1_PHB = 0;
-      MOTOR1_PHC = 1;
-      MOTOR1_PHD = 0;
-      break;
-    case 3:
-      MOTOR1_PHA = 1;
-      MOTOR1_PHB = 0;
-      MOTOR1_PHC = 0;
-      MOTOR1_PHD = 1;
-      break;
-  	}
+	to_ramp = CNT_PER_RAMP;
+	ramp(&left);
+	ramp(&right);
   }
 
-	
-  if (motor_counter_right <= 0) 
+  // set the phases on the port pins at once, the coils of a stopped motor
+  // are off
+  if (left.speed != 0)
+	coil |= coils[left.phase_nb];
+  if (right.speed != 0)
+	coil |= coils[right.phase_nb] << 4;
+  LATD = coil;
+
+  if (wheel_idle(&left) && wheel_idle(&right))
   {
-	motor_counter_right=motor_counter_right_init; 
-  	if (right_speed < 0)
-    {
-      nbr_pas_right--;
-      motor_phase_right--;
-      if (motor_phase_right < 0) motor_phase_right = 3;
-    }
-    else 
-    {
-      nbr_pas_right++;
-      motor_phase_right++;
-      if (motor_phase_right > 3) motor_phase_right = 0;
-    }
-  
-  	// set the phase on the port pins
-
-  	switch (motor_phase_right)
-  	{
-    case 0:
-      MOTOR2_PHA = 0;
-      MOTOR2_PHB = 1;
-      MOTOR2_PHC = 0;
-      MOTOR2_PHD = 1;
-      break;
-    case 1:
-      MOTOR2_PHA = 0;
-      MOTOR2_PHB = 1;
-      MOTOR2_PHC = 1;
-      MOTOR2_PHD = 0;
-      break;
-    case 2:
-      MOTOR2_PHA = 1;
-      MOTOR2_PHB = 0;
-      MOTOR2_PHC = 1;
-      MOTOR2_PHD = 0;
-      break;
-    case 3:
-      MOTOR2_PHA = 1;
-      MOTOR2_PHB = 0;
-      MOTOR2_PHC = 0;
-      MOTOR2_PHD = 1;
-      break;
-  	}
+	T3CONbits.TON = 0;           // sleep until the next speed is set
+	E_PROF_EXIT(E_PROF_T3);
+	return;
   }
 
+  // the next event
+  period = next_step(&right, next_step(&left, to_ramp));
+  if (period < CNT_MIN && to_ramp > CNT_MIN)
+	period = CNT_MIN;
+  PR3 = period - 1;
+  if (TMR3 >= period - 1)
+  {
+	// delayed by higher interrupts past the event, handle it at once
+	TMR3 = 0;
+	IFS0bits.T3IF = 1;
+  }
+  E_PROF_EXIT(E_PROF_T3);
+}
 
+static int clamp_speed(int motor_speed)
+{
+	if (motor_speed > 1000)
+		return 1000;
+	if (motor_speed < -1000)
+		return -1000;
+	return motor_speed;
 }
 
+/* the speed of a move, from 1 to 1000: at 0 the steps would never be made */
+static int move_speed(int motor_speed)
+{
+	motor_speed = clamp_speed(abs(motor_speed));
+	return motor_speed < 1 ? 1 : motor_speed;
+}
 
 /* ---- user calls ---- */
 
@@ -222,29 +286,37 @@ void e_set_steps_right(int set_steps)
   INTERRUPT_ON();
 }
 
+/*! \brief Give the steps of both motors at the same time
+ *
+ * Unlike \ref e_get_steps_left and \ref e_get_steps_right, the counters are
+ * 32 bit wide and \ref e_set_steps_left / \ref e_set_steps_right don't
+ * change them.
+ * \param left_steps Where to store the steps of the left motor
+ * \param right_steps Where to store the steps of the right motor
+ */
+void e_get_steps_long(long *left_steps, long *right_steps)
+{
+  INTERRUPT_OFF();
+  *left_steps = steps_left;
+  *right_steps = steps_right;
+  INTERRUPT_ON();
+}
+
 /*! \brief Manage the left speed
  *
  * This function manage the left motor speed by changing the MOTOR1
  * phases. The changing phases frequency (=> speed) is controled by
- * the timer3.
+ * the timer3; the speed is ramped to \a motor_speed with the acceleration
+ * set by \ref e_set_acceleration. It cancels a move of the left motor.
  * \param motor_speed from -1000 to 1000 give the motor speed in steps/s,
  * positive value to go forward and negative to go backward.
  */
 void e_set_speed_left(int motor_speed)  // motor speed in steps/s
 {
 	INTERRUPT_OFF();
-	if (motor_speed != 0)
-	{
-		if (motor_speed > 999)
-			motor_speed = 999;
-		if (motor_speed <= -999)
-			motor_speed = -999; 
-		motor_counter_left=abs(10000/motor_speed);
-	}
-	else 
-		motor_counter_left=9999;	
-	motor_counter_left_init = motor_counter_left;
-	left_speed = motor_speed;
+	left.remaining = -1;
+	left.target = clamp_speed(motor_speed);
+	wake_up();
 	INTERRUPT_ON();	
 }
 
@@ -252,25 +324,81 @@ void e_set_speed_left(int motor_speed)  // motor speed in steps/s
  *
  * This function manage the right motor speed by changing the MOTOR2
  * phases. The changing phases frequency (=> speed) is controled by
- * the timer3.
+ * the timer3; the speed is ramped to \a motor_speed with the acceleration
+ * set by \ref e_set_acceleration. It cancels a move of the right motor.
  * \param motor_speed from -1000 to 1000 give the motor speed in steps/s,
  * positive value to go forward and negative to go backward.
  */
 void e_set_speed_right(int motor_speed)  // motor speed in steps/s
 {
 	INTERRUPT_OFF();
-	if (motor_speed != 0)
-	{
-		if (motor_speed > 999)
-			motor_speed = 999;
-		if (motor_speed < -999)
-			motor_speed = -999;
-		motor_counter_right=abs(10000/motor_speed);
-	}
-	else 
-		motor_counter_right=9999;	
-	motor_counter_right_init = motor_counter_right;	
-	right_speed = motor_speed;
+	right.remaining = -1;
+	right.target = clamp_speed(motor_speed);
+	wake_up();
+	INTERRUPT_ON();
+}
+
+/*! \brief Make a given number of steps with the left motor
+ *
+ * The motor accelerates to \a motor_speed, brakes so that it reaches
+ * \ref E_MOTOR_MIN_SPEED just before the end and stops after the last step.
+ * The function returns at once, see \ref e_motors_moving.
+ * \param steps The number of steps, negative to go backward
+ * \param motor_speed The speed in steps/s, from 1 to 1000 (0 is taken as 1)
+ */
+void e_move_left(int steps, int motor_speed)
+{
+	motor_speed = move_speed(motor_speed);
+	INTERRUPT_OFF();
+	left.remaining = steps != 0 ? abs(steps) : -1;
+	left.target = steps != 0 ? (steps < 0 ? -motor_speed : motor_speed) : 0;
+	wake_up();
+	INTERRUPT_ON();
+}
+
+/*! \brief Make a given number of steps with the right motor
+ * \param steps The number of steps, negative to go backward
+ * \param motor_speed The speed in steps/s, from 1 to 1000 (0 is taken as 1)
+ * \sa e_move_left
+ */
+void e_move_right(int steps, int motor_speed)
+{
+	motor_speed = move_speed(motor_speed);
+	INTERRUPT_OFF();
+	right.remaining = steps != 0 ? abs(steps) : -1;
+	right.target = steps != 0 ? (steps < 0 ? -motor_speed : motor_speed) : 0;
+	wake_up();
+	INTERRUPT_ON();
+}
+
+/*! \brief Check if a move is in progress
+ * \return Non-zero until both motors made the steps of their last move
+ * \sa e_move_left, e_move_right
+ */
+int e_motors_moving(void)
+{
+	return left.remaining > 0 || right.remaining > 0;
+}
+
+/*! \brief Check if a wheel turns
+ * \return Non-zero while a wheel turns or ramps down to its stop
+ */
+int e_motors_running(void)
+{
+	return !wheel_idle(&left) || !wheel_idle(&right);
+}
+
+/*! \brief Set the acceleration of both motors
+ * \param steps_s2 The acceleration in steps/s^2, 0 to change the speed at
+ * once like without profile
+ */
+void e_set_acceleration(int steps_s2)
+{
+	INTERRUPT_OFF();
+	accel = abs(steps_s2);
+	accel_inc = (accel * (1L << SPEED_FRAC)) / 1000;
+	if (accel != 0 && accel_inc == 0)
+		accel_inc = 1;
 	INTERRUPT_ON();
 }
 
@@ -284,19 +412,20 @@ void e_init_motors(void)
 {
     T3CONbits.TON = 0;            // stop Timer3
   	e_init_port();					  // init general ports
-    left_speed = 0;
-	right_speed = 0;
-	motor_counter_left_init=9999;
-	motor_counter_right_init=9999;
-	motor_counter_left=9999;
-	motor_counter_right=9999;	
+	left.target = left.speed = 0;
+	left.phase = 0;
+	left.remaining = -1;
+	right.target = right.speed = 0;
+	right.phase = 0;
+	right.remaining = -1;
+
+    LATD &= 0xFF00;               // coils off
 
     T3CON = 0;                    // 
-    T3CONbits.TCKPS=3;            // prescsaler = 256
+    T3CONbits.TCKPS=1;            // prescsaler = 8
     TMR3 = 0;                     // clear timer 3
-    PR3 = (FCY/256)/10000;  	  // interrupt every 0.1ms with 256 prescaler
     IFS0bits.T3IF = 0;            // clear interrupt flag
     IEC0bits.T3IE = 1;            // set interrupt enable bit
-    T3CONbits.TON = 1;            // start Timer3
+    // Timer3 is started by the first speed or move
 }
 
@@ -0,0 +1,104 @@
+/*! \file
+ * \ingroup profile
+ * \brief Cycle counters for the interrupts and the main loop.
+ * \author Code: Darius Kellermann
+ */
+
+#include "e_profile.h"
+
+#if DBG_INCLUDE_PROFILE == 1
+
+struct e_prof_stat e_prof_isr[E_PROF_NB];	// the interrupts
+struct e_prof_stat e_prof_loop;			// the passes of the main loop
+unsigned int e_prof_latency[E_PROF_LAT_NB];	// longest entry delays
+
+static volatile unsigned int overflows = 0;	// high word of the time
+
+void __attribute__((interrupt, auto_psv))
+_T2Interrupt(void)
+{
+	E_PROF_LATENCY(E_PROF_LAT_T2, TMR2);
+	IFS0bits.T2IF = 0;
+	overflows++;
+}
+
+/*! \brief Start Timer2 as the cycle counter
+ *
+ * Its priority (4) is below the camera and the UARTs, so it delays them
+ * by a few cycles at most.
+ */
+void e_prof_init(void)
+{
+	T2CON = 0;			// internal clock, 1:1 prescaler
+	TMR2 = 0;
+	PR2 = 0xFFFF;
+	IFS0bits.T2IF = 0;
+	IPC1bits.T2IP = 4;
+	IEC0bits.T2IE = 1;
+	T2CONbits.TON = 1;
+}
+
+/*! \brief Give the cycles since \ref e_prof_init
+ *
+ * \warning Not from an interrupt of priority 4 or more, the overflows would
+ * not be counted during it.
+ * \return The time, in cycles (it wraps around after 291 s)
+ */
+unsigned long e_prof_time(void)
+{
+	unsigned int hi, lo;
+
+	do {
+		hi = overflows;
+		lo = TMR2;
+		if (IFS0bits.T2IF && (lo < 0x8000))
+			hi++;			// the overflow is pending
+	} while (hi != overflows);
+	return ((unsigned long)hi << 16) | lo;
+}
+
+/*! \brief Copy a statistic updated by an interrupt, and restart its max
+ * \param stat The statistic
+ * \param copy Where to store the copy
+ */
+void e_prof_read(struct e_prof_stat *stat, struct e_prof_stat *copy)
+{
+	volatile struct e_prof_stat *s = stat;
+
+	do {
+		copy->count = s->count;
+		copy->total = s->total;
+	} while (copy->count != s->count);
+	copy->max = s->max;
+	s->max = 0;
+}
+
+/*! \brief Give the longest entry delay of an interrupt, and restart it
+ * \param id The interrupt, E_PROF_LAT_T1 to E_PROF_LAT_T3
+ * \return The delay in cycles since the last call
+ */
+unsigned int e_prof_read_latency(int id)
+{
+	unsigned int max = e_prof_latency[id];
+
+	e_prof_latency[id] = 0;
+	return max;
+}
+
+/*! \brief Record the state of a state machine
+ *
+ * The time since the last call is added to the state of the last call.
+ * \param fsm The statistics of the state machine
+ * \param state The current state, below \ref E_PROF_FSM_STATES
+ */
+void e_prof_state(struct e_prof_fsm *fsm, int state)
+{
+	unsigned long now = e_prof_time();
+
+	if (fsm->since != 0)
+		fsm->time[fsm->state] += now - fsm->since;
+	fsm->since = now;
+	fsm->state = state;
+}
+
+#endif
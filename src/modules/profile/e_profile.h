@@ -0,0 +1,154 @@
+/*! \file
+ * \ingroup profile
+ * \brief Cycle counters for the interrupts and the main loop.
+ *
+ * Timer2 runs free at FCY, its interrupt extends it to 32 bits. An
+ * interrupt routine reads TMR2 at its entry and at its exit, and adds the
+ * difference to its \ref e_prof_stat. The times include the interrupts of
+ * higher priority that preempted it.
+ *
+ * Everything is compiled in only if DBG_INCLUDE_PROFILE is 1 in
+ * configuration.h, otherwise the macros are empty. This header can be
+ * included by the ASM files too.
+ * \author Code: Darius Kellermann
+ */
+
+/*! \defgroup profile Profiling
+ *
+ * \section intro_sec Introduction
+ * This package measures how many cycles the interrupts and the code of the
+ * main loop take. The statistics are only added to: read them twice and
+ * take the difference, the counts wrap around.
+ *
+ * \warning The package uses Timer2.
+ * \author Doc: Darius Kellermann
+ */
+
+#ifndef _PROFILE
+#define _PROFILE
+
+#include "../../configuration.h"
+
+/* The measured interrupts */
+#define E_PROF_T1	0	/*!< Scheduler tick */
+#define E_PROF_T3	1	/*!< Motors */
+#define E_PROF_T4	2	/*!< Camera HSYNC, only counted */
+#define E_PROF_T5	3	/*!< Camera VSYNC */
+#define E_PROF_ADC	4	/*!< ADC scan */
+#define E_PROF_MI2C	5	/*!< I2C master */
+#define E_PROF_U1RX	6	/*!< UART1 reception */
+#define E_PROF_U1TX	7	/*!< UART1 transmission */
+#define E_PROF_NB	8
+
+#define E_PROF_STAT_SIZE	8	/* bytes of a struct e_prof_stat */
+
+/* The interrupts whose entry delay is measured, read from their timer */
+#define E_PROF_LAT_T1	0	/*!< Scheduler tick */
+#define E_PROF_LAT_T2	1	/*!< Overflow of the cycle counter */
+#define E_PROF_LAT_T3	2	/*!< Motors */
+#define E_PROF_LAT_NB	3
+
+#ifndef __ASSEMBLER__
+
+#include <p30F6014A.h>
+
+/*! \brief The statistics of a piece of code */
+struct e_prof_stat {
+	unsigned int count;	/*!< Number of runs, it wraps around */
+	unsigned int max;	/*!< Longest run in cycles, see e_prof_read */
+	unsigned long total;	/*!< Cycles of all the runs, it wraps around */
+};
+
+#define E_PROF_FSM_STATES	8	/*!< States of a struct e_prof_fsm */
+
+/*! \brief The time spent in each state of a state machine */
+struct e_prof_fsm {
+	unsigned long since;	/*!< Time of the last change */
+	int state;		/*!< The current state */
+	unsigned long time[E_PROF_FSM_STATES];	/*!< Cycles in each state */
+};
+
+extern struct e_prof_stat e_prof_isr[E_PROF_NB];
+extern struct e_prof_stat e_prof_loop;
+extern unsigned int e_prof_latency[E_PROF_LAT_NB];
+
+void e_prof_init(void);
+unsigned long e_prof_time(void);
+void e_prof_read(struct e_prof_stat *stat, struct e_prof_stat *copy);
+unsigned int e_prof_read_latency(int id);
+void e_prof_state(struct e_prof_fsm *fsm, int state);
+
+/*! \brief Add a run to a statistic
+ * \param stat The statistic
+ * \param cycles The length of the run, the max saturates at 65535
+ */
+static inline void e_prof_add(struct e_prof_stat *stat, unsigned long cycles)
+{
+	stat->count++;
+	stat->total += cycles;
+	if (cycles > stat->max)
+		stat->max = (cycles > 0xFFFF) ? 0xFFFF : cycles;
+}
+
+#if DBG_INCLUDE_PROFILE == 1
+/*! Starts the measure of an interrupt, after its declarations */
+#define E_PROF_ENTER()	unsigned int e_prof_t0 = TMR2
+/*! Ends the measure of the interrupt id */
+#define E_PROF_EXIT(id)	e_prof_add(&e_prof_isr[id], \
+				(unsigned int)(TMR2 - e_prof_t0))
+/*! Records the entry delay of the interrupt id, the cycles since its timer
+ * matched, at the entry of the interrupt: the time it waited for the ones
+ * of higher or equal priority and the masked sections */
+#define E_PROF_LATENCY(id, cycles)	do {				\
+		unsigned int e_prof_l = (cycles);			\
+		if (e_prof_l > e_prof_latency[id])			\
+			e_prof_latency[id] = e_prof_l;			\
+	} while (0)
+/*! Records the state of a state machine, see \ref e_prof_state */
+#define E_PROF_STATE(fsm, state)	e_prof_state(fsm, state)
+#else
+#define E_PROF_ENTER()
+#define E_PROF_EXIT(id)
+#define E_PROF_LATENCY(id, cycles)
+#define E_PROF_STATE(fsm, state)
+#endif
+
+#else /* __ASSEMBLER__ */
+
+; Starts the measure of an interrupt, t0 is saved and then holds the time
+.macro E_PROF_ENTER t0
+#if DBG_INCLUDE_PROFILE == 1
+		push	\t0
+		mov		TMR2, \t0
+#endif
+.endm
+
+; Ends the measure of the interrupt id, tmp is used and must be saved
+.macro E_PROF_EXIT id, t0, tmp
+#if DBG_INCLUDE_PROFILE == 1
+		mov		TMR2, \tmp
+		sub		\tmp, \t0, \t0				; cycles of the run
+		mov		#(_e_prof_isr + E_PROF_STAT_SIZE * \id), \tmp
+		inc		[\tmp], [\tmp++]			; count
+		cp		\t0, [\tmp]
+		bra		LEU, 1f
+		mov		\t0, [\tmp]					; max
+1:
+		inc2	\tmp, \tmp
+		add		\t0, [\tmp], [\tmp++]		; total, low word
+		mov		#0, \t0
+		addc	\t0, [\tmp], [\tmp]			; total, high word
+		pop		\t0
+#endif
+.endm
+
+; Counts a run of the interrupt id, without measuring it
+.macro E_PROF_COUNT id
+#if DBG_INCLUDE_PROFILE == 1
+		inc		_e_prof_isr + E_PROF_STAT_SIZE * \id
+#endif
+.endm
+
+#endif /* __ASSEMBLER__ */
+
+#endif
@@ -97,12 +97,71 @@ int  e_ischar_uart1();
  */
 int  e_getchar_uart1(char *car);
 
-/*! \brief Send a buffer of char of size length
+/*! \brief Read the available chars, up to max
+ * \param buff The array where the chars will be stored
+ * \param max The size of the array
+ * \return the number of chars read, 0 if no char is available
+ */
+int  e_read_uart1(char *buff, int max);
+
+/*! \brief Like \ref e_read_uart1, but the chars stay in the reception buffer
+ *
+ * Useful to look at a message header before the whole message is there.
+ * \param buff The array where the chars will be stored
+ * \param max The size of the array
+ * \return the number of chars copied
+ */
+int  e_peek_uart1(char *buff, int max);
+
+/*! \brief Look for a delimiter in the received chars, without reading them
+ * \param delim The delimiter
+ * \return the number of chars up to and including the first delimiter,
+ * 0 if the delimiter has not been received
+ */
+int  e_find_char_uart1(char delim);
+
+/*! Number of bytes lost because the uart 1 reception buffer was full, the
+ * size of the buffer is set in e_uart1_rx_char.S (256 bytes by default) */
+extern volatile unsigned int U1RXOvfCnt;
+
+/*! Number of bytes received on uart 1 since \ref e_init_uart1, it wraps
+ * around */
+extern volatile unsigned int U1RXRcvCnt;
+
+/*! Number of segments that can be queued on uart 1, including the one
+ * in transmission */
+#define E_UART1_TX_SEGS	7
+
+/*! \brief One segment of data to send with \ref e_send_uart1_segs */
+struct e_uart_seg {
+	const char *buff;	/*!< The top of the array where the data are stored */
+	int length;		/*!< The length of the array to send */
+};
+
+/*! \brief Queue a buffer of char of size length
+ *
+ * Only waits if \ref E_UART1_TX_SEGS segments are already queued. The buffer
+ * is not copied, it must not be changed until \ref e_uart1_sending returns 0.
  * \param buff The top of the array where the data are stored
  * \param length The length of the array to send
  */
 void e_send_uart1_char(const char * buff, int length);
 
+/*! \brief Queue several buffers, sent without gap between them
+ *
+ * Never waits: either all the segments are queued, or none. The buffers
+ * are not copied, the array of segments is.
+ * \param segs The segments to send, in order
+ * \param count The number of segments
+ * \return 1 if the segments are queued, 0 if there is not enough room
+ */
+int  e_send_uart1_segs(const struct e_uart_seg *segs, int count);
+
+/*! \brief Give the number of segments that can be queued without waiting
+ * \return The free room of the queue, in segments
+ */
+int  e_uart1_tx_free(void);
+
 /*! \brief  To check if the sending operation is done
  * \return 1 if buffer sending is in progress, return 0 if not
  */
@@ -122,6 +181,24 @@ int  e_ischar_uart2();
  */
 int  e_getchar_uart2(char *car);
 
+/*! \brief Read the available chars, up to max
+ * \param buff The array where the chars will be stored
+ * \param max The size of the array
+ * \return the number of chars read, 0 if no char is available
+ */
+int  e_read_uart2(char *buff, int max);
+
+/*! \brief Like \ref e_read_uart2, but the chars stay in the reception buffer
+ * \param buff The array where the chars will be stored
+ * \param max The size of the array
+ * \return the number of chars copied
+ */
+int  e_peek_uart2(char *buff, int max);
+
+/*! Number of bytes received on uart 2 since \ref e_init_uart2, it wraps
+ * around. The reception buffer holds 64 bytes. */
+extern volatile unsigned int U2RXRcvCnt;
+
 /*! \brief Send a buffer of char of size length
  * \param buff The top of the array where the datas are stored
  * \param length The length of the array
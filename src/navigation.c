@@ -0,0 +1,83 @@
+/*!
+ * \file	navigation.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * The weighted sums are done by nav_dot() in navigation_mac.S, with the MAC
+ * instruction of the DSP engine.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include "configuration.h"
+#include "navigation.h"
+
+/*!
+ * The weights in use. An obstacle slows down the wheel on its side and
+ * speeds up the other one, so the robot steers away from it as much as it
+ * is close. The front right sensor weighs a bit more, so that an obstacle
+ * straight ahead is avoided to the left like before.
+ */
+static struct puck_msg_nav weights = {
+	{-200, -128, -16, 0, 0, 16, 64, 64},
+	{64, 64, 16, 0, 0, -16, -128, -128},
+	{MOVING_SPEED, MOVING_SPEED}
+};
+
+static int clamp_speed(long speed)
+{
+	if (speed > NAV_MAX_SPEED)
+		return NAV_MAX_SPEED;
+	if (speed < -NAV_MAX_SPEED)
+		return -NAV_MAX_SPEED;
+	return speed;
+}
+
+/*!
+ * Replaces the weights.
+ *
+ * \param	w	The new weights, as received in PMT_NAV_WEIGHTS.
+ */
+void nav_set_weights(const struct puck_msg_nav *w)
+{
+	weights = *w;
+}
+
+/*!
+ * Sets the speed without obstacle, the bias of both wheels.
+ *
+ * \param	speed	The speed in steps/s.
+ */
+void nav_set_speed(int speed)
+{
+	weights.bias[0] = speed;
+	weights.bias[1] = speed;
+}
+
+/*!
+ * Gives the wheel speeds for the given proximity values.
+ *
+ * \param	prox	The eight proximity values.
+ * \param	left	Where to store the speed of the left wheel.
+ * \param	right	Where to store the speed of the right wheel.
+ */
+void nav_speeds(const int *prox, int *left, int *right)
+{
+	*left = clamp_speed(weights.bias[0]
+			+ (nav_dot(weights.left, prox, 8) >> 8));
+	*right = clamp_speed(weights.bias[1]
+			+ (nav_dot(weights.right, prox, 8) >> 8));
+}
+
+/*!
+ * @}
+ */
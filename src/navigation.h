@@ -0,0 +1,42 @@
+/*!
+ * \file	navigation.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Obstacle avoidance as a Braitenberg vehicle: each wheel speed is a
+ * weighted sum of the eight proximity values. The weights can be replaced
+ * at run time with PMT_NAV_WEIGHTS.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef NAVIGATION_H_
+#define NAVIGATION_H_
+
+#include "pucom_ext.h"
+
+/*!
+ * The highest wheel speed set by the navigation, in steps/s.
+ */
+#define NAV_MAX_SPEED	1000
+
+void nav_set_weights(const struct puck_msg_nav *weights);
+void nav_set_speed(int speed);
+void nav_speeds(const int *prox, int *left, int *right);
+
+long nav_dot(const int16_t *w, const int *x, int n);
+
+#endif /* NAVIGATION_H_ */
+
+/*!
+ * @}
+ */
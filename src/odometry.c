@@ -0,0 +1,222 @@
+/*!
+ * \file	odometry.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * The steps made since the last update are integrated in chunks of at most
+ * ODO_CHUNK steps per wheel, so that every product fits a 16x16 bit
+ * multiplication. Each chunk moves the robot along the heading at its
+ * middle. The heading is a binary angle with 16 more fractional bits.
+ *
+ * The slip detection compares the change of the wheel speed since the last
+ * update with the change given by the accelerometer. Both are taken as
+ * magnitudes, so the orientation of the sensor does not matter. A constant
+ * speed against an obstacle is not seen, but collisions, pushes and wheels
+ * slipping while accelerating are.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <stdlib.h>
+
+#include <motor_led/e_motors.h>
+#include <a_d/advance_ad_scan/e_ad_conv.h>
+#include <a_d/advance_ad_scan/e_acc.h>
+
+#include "configuration.h"
+#include "utility.h"
+#include "odometry.h"
+
+/*!
+ * Maximum number of steps per wheel integrated at once.
+ */
+#define ODO_CHUNK	15
+
+/*!
+ * Travel of a wheel per step, in 1/16 um.
+ */
+#define STEP_Q4UM	((int)(M_PI * WHEEL_DIAMETER * 16000.0 / STEPS_PER_REV \
+				+ 0.5))
+
+/*!
+ * Heading change per step of difference between the wheels, in 1/65536 of
+ * a binary angle.
+ */
+#define DTHETA_Q	((long)(WHEEL_DIAMETER * 4294967296.0 /		\
+				(2.0 * STEPS_PER_REV * WHEEL_DISTANCE)))
+
+/*!
+ * The first quarter of a sine wave, in Q15.
+ */
+static const int sin_table[65] = {
+	0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739,
+	9512, 10278, 11039, 11793, 12539, 13279, 14010, 14732, 15446, 16151,
+	16846, 17530, 18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+	23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790, 27245, 27683,
+	28105, 28510, 28898, 29268, 29621, 29956, 30273, 30571, 30852, 31113,
+	31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678,
+	32728, 32757, 32767
+};
+
+static struct odo_pose pose;
+static unsigned long theta_q;	/*!< Heading with 16 fractional bits */
+static long last_left;		/*!< Steps at the last update */
+static long last_right;
+static unsigned long last_time;	/*!< e_ad_get_time() at the last update */
+static long last_speed;		/*!< Wheel speed at the last update, mm/s */
+static int acc_zero;		/*!< Accelerometer value at rest */
+static long slip_level;		/*!< Filtered speed difference, mm/s */
+
+/*!
+ * Gives the sine of a binary angle, interpolated in a table.
+ *
+ * \param	angle	The angle, 65536 is a full turn.
+ *
+ * \return	The sine in Q15.
+ */
+int odo_sin(unsigned int angle)
+{
+	unsigned int i = (angle >> 8) & 0x3F;
+	unsigned int frac = angle & 0xFF;
+	int s0, s1, s;
+
+	if (angle & 0x4000) {
+		/* second quarter, the table is read backwards */
+		s0 = sin_table[64 - i];
+		s1 = sin_table[63 - i];
+	}
+	else {
+		s0 = sin_table[i];
+		s1 = sin_table[i + 1];
+	}
+	s = s0 + (__builtin_mulss(s1 - s0, frac) >> 8);
+	return (angle & 0x8000) ? -s : s;
+}
+
+static int clamp_chunk(long steps)
+{
+	if (steps > ODO_CHUNK)
+		return ODO_CHUNK;
+	if (steps < -ODO_CHUNK)
+		return -ODO_CHUNK;
+	return steps;
+}
+
+/*!
+ * Sets the pose to (0, 0, 0) and measures the accelerometer at rest.
+ *
+ * \warning	The robot must stand still.
+ */
+void odo_init(void)
+{
+	unsigned long start;
+	int x, y, z;
+
+	e_init_acc();
+	start = e_ad_get_time();
+	while (e_ad_get_time() - start < 2 * ACC_SAMP_NB)
+		;
+	e_get_acc(&x, &y, &z);
+	acc_zero = y;
+
+	e_get_steps_long(&last_left, &last_right);
+	last_time = e_ad_get_time();
+	last_speed = 0;
+	slip_level = 0;
+	theta_q = 0;
+	pose.x = 0;
+	pose.y = 0;
+	pose.theta = 0;
+	pose.flags = 0;
+}
+
+/*!
+ * Integrates the steps made since the last call, it should run every few
+ * tens of ms.
+ */
+void odo_update(void)
+{
+	long left, right, dl, dr, dist = 0, dtheta;
+	long dt_us, speed, dv_acc;
+	unsigned long now;
+	unsigned int mid;
+	int cl, cr, d, x, y, z;
+
+	e_get_steps_long(&left, &right);
+	dl = left - last_left;
+	dr = right - last_right;
+	last_left = left;
+	last_right = right;
+
+	while ((dl != 0) || (dr != 0)) {
+		cl = clamp_chunk(dl);
+		cr = clamp_chunk(dr);
+		dl -= cl;
+		dr -= cr;
+
+		d = __builtin_mulss(cl + cr, STEP_Q4UM) >> 1;
+		dtheta = (long)(cr - cl) * DTHETA_Q;
+		mid = (theta_q + dtheta / 2) >> 16;
+		pose.x += __builtin_mulss(d, odo_cos(mid)) >> 15;
+		pose.y += __builtin_mulss(d, odo_sin(mid)) >> 15;
+		theta_q += dtheta;
+		dist += d;
+	}
+	pose.theta = theta_q >> 16;
+
+	/* slip detection */
+	now = e_ad_get_time();
+	dt_us = (now - last_time) * (AD_SCAN_PERIOD_NS / 1000);
+	last_time = now;
+	if (dt_us == 0)
+		return;
+
+	speed = (dist >> 4) * 1000 / dt_us;
+	e_get_acc(&x, &y, &z);
+	dv_acc = (long)(y - acc_zero) * 9810 / ODO_ACC_PER_G
+			* (dt_us / 1000) / 1000;
+	slip_level += labs(labs(speed - last_speed) - labs(dv_acc))
+			- slip_level / 4;
+	last_speed = speed;
+
+	if (slip_level > 4 * ODO_SLIP_LEVEL)
+		pose.flags |= ODO_SLIP;
+	else
+		pose.flags &= ~ODO_SLIP;
+}
+
+/*!
+ * Gives the pose at the last update.
+ *
+ * \param	p	Where to store the pose.
+ */
+void odo_get_pose(struct odo_pose *p)
+{
+	*p = pose;
+}
+
+/*!
+ * Fills a PMT_POSE payload with the pose at the last update.
+ *
+ * \param	msg	The payload.
+ */
+void odo_get_msg(struct puck_msg_pose *msg)
+{
+	msg->x = pose.x >> 4;
+	msg->y = pose.y >> 4;
+	msg->theta = pose.theta;
+	msg->flags = pose.flags;
+}
+
+/*!
+ * @}
+ */
@@ -0,0 +1,63 @@
+/*!
+ * \file	odometry.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Dead reckoning from the motor steps, in fixed point. The pose starts at
+ * (0, 0) facing the x axis when odo_init() is called.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef ODOMETRY_H_
+#define ODOMETRY_H_
+
+#include "pucom_ext.h"
+
+/*!
+ * The flags of a pose.
+ */
+enum ODO_FLAGS {
+	/*!
+	 * The accelerometer disagrees with the wheels, they slip or the robot
+	 * is pushed or blocked.
+	 */
+	ODO_SLIP = 0x01
+};
+
+/*!
+ * The pose of the robot.
+ */
+struct odo_pose {
+	long x;			/*!< In 1/16 um */
+	long y;			/*!< In 1/16 um */
+	unsigned int theta;	/*!< Heading, 65536 is a full turn, CCW */
+	unsigned int flags;	/*!< \ref ODO_FLAGS */
+};
+
+void odo_init(void);
+void odo_update(void);
+void odo_get_pose(struct odo_pose *pose);
+void odo_get_msg(struct puck_msg_pose *msg);
+
+int odo_sin(unsigned int angle);
+
+/*!
+ * The cosine of a binary angle, in Q15.
+ */
+#define odo_cos(angle)	odo_sin((angle) + 0x4000U)
+
+#endif /* ODOMETRY_H_ */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,198 @@
+/*!
+ * \file	params.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * The block in the data EEPROM holds the values in the order of
+ * PUCK_PARAMS, then a magic word with the version of the block. A block of
+ * another version is ignored, the robot then starts with the values of
+ * configuration.h. The magic word is erased first and written last, like
+ * the calibration of the proximity sensors, so an interrupted save leaves
+ * no valid block.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <libpic30.h>
+
+#include <camera/fast_2_timer/e_poxxxx.h>
+
+#include "configuration.h"
+#include "navigation.h"
+#include "params.h"
+
+/*!
+ * Version of the block, to be increased when PUCK_PARAMS changes.
+ */
+#define PARAMS_VERSION	1
+
+/*!
+ * Magic word behind the values, "P" and the version.
+ */
+#define PARAMS_EE_MAGIC	(0x5000 | PARAMS_VERSION)
+
+/*!
+ * The values a parameter takes, and its value from configuration.h.
+ */
+struct param_range {
+	int min;
+	int max;
+	int def;
+};
+
+/*
+ * A parameter of a module that is not included only takes 0.
+ */
+static const struct param_range ranges[PP_COUNT] = {
+#if DBG_INCLUDE_MOTION == 1
+	[PP_MOVING_SPEED] = {-NAV_MAX_SPEED, NAV_MAX_SPEED, MOVING_SPEED},
+	[PP_MOTION_ACCEL] = {0, 0x7FFF, MOTION_ACCEL},
+#endif	/* DBG_INCLUDE_MOTION */
+#if DBG_INCLUDE_CAM == 1
+	[PP_IMG_W] = {1, IMG_W, IMG_W},
+	[PP_IMG_H] = {1, IMG_H, IMG_H},
+	[PP_IMG_SS] = {1, 16, IMG_SS},
+#endif	/* DBG_INCLUDE_CAM */
+};
+
+static int values[PP_COUNT];	/*!< The values in effect */
+
+static int __attribute__((space(eedata), aligned(2))) ee_params[PP_COUNT + 1];
+
+/*!
+ * Checks a set of values: each one is in its range and the image fits the
+ * sensor.
+ */
+static int valid(const int *v)
+{
+	unsigned int i;
+
+	for (i = 0; i < PP_COUNT; i++)
+		if ((v[i] < ranges[i].min) || (v[i] > ranges[i].max))
+			return 0;
+#if DBG_INCLUDE_CAM == 1
+	if ((v[PP_IMG_W] * v[PP_IMG_SS] > ARRAY_WIDTH)
+			|| (v[PP_IMG_H] * v[PP_IMG_SS] > ARRAY_HEIGHT))
+		return 0;
+#endif	/* DBG_INCLUDE_CAM */
+	return 1;
+}
+
+/*!
+ * Loads the values saved by params_save(), or those of configuration.h.
+ *
+ * \return	1 if they were loaded, 0 if the EEPROM holds no valid block.
+ */
+int params_load(void)
+{
+	_prog_addressT p;
+	int ee[PP_COUNT + 1];
+	unsigned int i;
+
+	for (i = 0; i < PP_COUNT; i++)
+		values[i] = ranges[i].def;
+	_init_prog_address(p, ee_params);
+	_memcpy_p2d16(ee, p, sizeof(ee));
+	if ((ee[PP_COUNT] != PARAMS_EE_MAGIC) || !valid(ee))
+		return 0;
+	for (i = 0; i < PP_COUNT; i++)
+		values[i] = ee[i];
+	return 1;
+}
+
+/*!
+ * Saves the values in the data EEPROM. Only the words that changed are
+ * written, each one blocks about 4 ms.
+ */
+void params_save(void)
+{
+	_prog_addressT p, magic;
+	int ee[PP_COUNT + 1], keep;
+	unsigned int i;
+
+	_init_prog_address(p, ee_params);
+	_memcpy_p2d16(ee, p, sizeof(ee));
+	keep = (ee[PP_COUNT] == PARAMS_EE_MAGIC);
+	for (i = 0; keep && (i < PP_COUNT); i++)
+		if (ee[i] != values[i])
+			break;
+	if (keep && (i == PP_COUNT))
+		return;		/* nothing changed */
+
+	magic = p + 2 * PP_COUNT;
+	_erase_eedata(magic, _EE_WORD);
+	_wait_eedata();
+	for (i = 0; i < PP_COUNT; i++, p += 2) {
+		if (keep && (ee[i] == values[i]))
+			continue;
+		_erase_eedata(p, _EE_WORD);
+		_wait_eedata();
+		_write_eedata_word(p, values[i]);
+		_wait_eedata();
+	}
+	_write_eedata_word(magic, PARAMS_EE_MAGIC);
+	_wait_eedata();
+}
+
+/*!
+ * Gives the value of a parameter.
+ *
+ * \param	id	\ref PUCK_PARAMS
+ *
+ * \return	The value in effect, 0 for an unknown parameter.
+ */
+int params_get(unsigned int id)
+{
+	return (id < PP_COUNT) ? values[id] : 0;
+}
+
+/*!
+ * Sets the value of a parameter. It is not saved.
+ *
+ * \param	id	\ref PUCK_PARAMS
+ * \param	value	The new value.
+ *
+ * \return	1 if the value was set, 0 if it does not fit.
+ */
+int params_set(unsigned int id, int value)
+{
+	int v[PP_COUNT];
+	unsigned int i;
+
+	if (id >= PP_COUNT)
+		return 0;
+	for (i = 0; i < PP_COUNT; i++)
+		v[i] = values[i];
+	v[id] = value;
+	if (!valid(v))
+		return 0;
+	values[id] = value;
+	return 1;
+}
+
+/*!
+ * Gives a parameter back a value it had before, the set of values it
+ * belongs to was valid. It is not checked, so that a set is restored one
+ * value after the other.
+ *
+ * \param	id	\ref PUCK_PARAMS
+ * \param	value	The earlier value.
+ */
+void params_revert(unsigned int id, int value)
+{
+	if (id < PP_COUNT)
+		values[id] = value;
+}
+
+/*!
+ * @}
+ */
@@ -0,0 +1,36 @@
+/*!
+ * \file	params.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * The parameters that can be tuned without flashing the robot, through
+ * PMT_PARAM. They are kept in the data EEPROM.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef PARAMS_H_
+#define PARAMS_H_
+
+#include "pucom_ext.h"
+
+int params_load(void);
+void params_save(void);
+int params_get(unsigned int id);
+int params_set(unsigned int id, int value);
+void params_revert(unsigned int id, int value);
+
+#endif /* PARAMS_H_ */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,104 @@
+/*!
+ * \file	power.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Between the events the scheduler puts the core into idle mode, in which
+ * the peripherals keep running. In sleep mode the oscillator stops as well,
+ * with all the timers, so the core only sleeps once everything is stopped:
+ * the selector is in position 0, the wheels stand still, the camera is in
+ * standby and the UARTs are done sending. The ADC scan is stopped here.
+ *
+ * The core wakes up when the selector turns, through the change
+ * notification of its pins (CN8 to CN11), or on the start bit of a
+ * character on a UART. That character is lost, the server sends it again
+ * after its timeout. The time of the scheduler stands still while the core
+ * sleeps.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <p30F6014A.h>
+
+#include <motor_led/e_epuck_ports.h>
+#include <motor_led/e_led.h>
+#include <a_d/advance_ad_scan/e_ad_conv.h>
+
+#include "configuration.h"
+#include "utility.h"
+#include "power.h"
+
+#if DBG_INCLUDE_POWER == 1
+
+/*!
+ * The change notification, it only wakes the core up.
+ */
+void __attribute__((interrupt, auto_psv))
+_CNInterrupt(void)
+{
+	IFS0bits.CNIF = 0;
+}
+
+/*!
+ * Enables the change notification on the selector pins, the interrupt is
+ * only enabled while the core sleeps.
+ */
+void power_init(void)
+{
+	IEC0bits.CNIE = 0;
+	CNEN1bits.CN8IE = 1;
+	CNEN1bits.CN9IE = 1;
+	CNEN1bits.CN10IE = 1;
+	CNEN1bits.CN11IE = 1;
+}
+
+/*!
+ * Puts the core into sleep mode until the selector turns or a UART
+ * receives, and restores the ADC scan.
+ *
+ * \warning	The selector must be in position 0 and the other peripherals
+ * 		stopped, see above.
+ */
+void power_sleep(void)
+{
+	int scan = ADCON1bits.ADON;
+
+	if (scan)
+		e_ad_scan_off();
+	e_set_led_mask(0);
+	e_set_body_led(0);
+	e_set_front_led(0);
+	U1MODEbits.WAKE = 1;
+#if TX_UART2 == 1
+	U2MODEbits.WAKE = 1;
+#endif	/* TX_UART2 */
+
+	/* the port is read last before the compare starts */
+	IFS0bits.CNIF = 0;
+	IEC0bits.CNIE = 1;
+	if (get_selector() == 0)
+		Sleep();
+	IEC0bits.CNIE = 0;
+
+	U1MODEbits.WAKE = 0;
+#if TX_UART2 == 1
+	U2MODEbits.WAKE = 0;
+#endif	/* TX_UART2 */
+	if (scan)
+		e_ad_scan_on();
+}
+
+#endif	/* DBG_INCLUDE_POWER */
+
+/*!
+ * @}
+ */
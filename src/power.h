@@ -0,0 +1,30 @@
+/*!
+ * \file	power.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Sleep mode of the core while the program selector is in position 0.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef POWER_H_
+#define POWER_H_
+
+void power_init(void);
+void power_sleep(void);
+
+#endif /* POWER_H_ */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,314 @@
+/*!
+ * \file	pucom_ext.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Message types added to the pucom protocol by this program. They use the
+ * range from 0x80 on, so they never collide with the types of pucom.h. Each
+ * message is a struct puck_msg_hdr followed by its payload, and is
+ * acknowledged with PMT_ACK like the pucom messages.
+ *
+ * This file only uses standard C, the server can include it.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef PUCOM_EXT_H_
+#define PUCOM_EXT_H_
+
+#include <stdint.h>
+
+/*!
+ * The message types of the extension.
+ */
+enum PUCK_MSG_TYPES_EXT {
+	/*!
+	 * An image coded as the difference to the previous image sent, see
+	 * img_codec.h. The previous image is the last PMT_VISUAL or
+	 * PMT_VISUAL_DELTA.
+	 */
+	PMT_VISUAL_DELTA = 0x80,
+	/*!
+	 * An image sent while it is captured: one record per row, made of
+	 * the row index (one byte) and the row. The records come in the
+	 * order of the rows.
+	 */
+	PMT_VISUAL_ROWS = 0x81,
+	/*!
+	 * The sum of each column of an image, one uint16_t per column
+	 * (little endian).
+	 */
+	PMT_VISUAL_PROFILE = 0x82,
+	/*!
+	 * The centroid of the bright pixels of an image, a
+	 * struct puck_msg_blob.
+	 */
+	PMT_VISUAL_BLOB = 0x83,
+	/*!
+	 * The pose of the robot from its odometry, a struct puck_msg_pose.
+	 */
+	PMT_POSE = 0x84,
+	/*!
+	 * Sent by the server: the weights of the navigation, a
+	 * struct puck_msg_nav. The robot answers with PMT_ACK.
+	 */
+	PMT_NAV_WEIGHTS = 0x85,
+	/*!
+	 * The cycle counters of the robot, a struct puck_msg_stats.
+	 */
+	PMT_STATS = 0x86,
+	/*!
+	 * An image message that is not acknowledged with PMT_ACK: a
+	 * struct puck_msg_seq, then the payload of its type (PMT_VISUAL,
+	 * PMT_VISUAL_DELTA, ...). The header and the payload come back to
+	 * back. The sequence starts at 0 after each PMT_CONFIG.
+	 */
+	PMT_VISUAL_SEQ = 0x87,
+	/*!
+	 * Sent by the server: the cumulative acknowledgment of the
+	 * PMT_VISUAL_SEQ, a struct puck_msg_seq_ack. A message out of sequence
+	 * is dropped by the server, the robot sends again from the first one
+	 * not acknowledged after a timeout, never as a delta.
+	 */
+	PMT_SEQ_ACK = 0x88,
+	/*!
+	 * The format of the pixels, a struct puck_msg_format. It follows
+	 * PMT_CONFIG when the images are not grayscale.
+	 */
+	PMT_VISUAL_FORMAT = 0x89,
+	/*!
+	 * A snapshot of the sensors and the step counters, a
+	 * struct puck_msg_sensors.
+	 */
+	PMT_SENSORS = 0x8A,
+	/*!
+	 * Sent by the server: the time slot of the robot in a swarm, a
+	 * struct puck_msg_slot, after the PMT_ACK of a PMT_CONFIG. The robot
+	 * answers with PMT_ACK, then only sends inside its slot and marks its
+	 * images with PMT_VISUAL_ID. A robot without a slot sends at any time.
+	 */
+	PMT_SLOT = 0x8B,
+	/*!
+	 * An image message marked with the robot that sent it: a
+	 * struct puck_msg_id, then the payload of its type. The header and the
+	 * payload come back to back, the server answers with PMT_ACK once it
+	 * has the whole message, or with PMT_SEQ_ACK for a PMT_VISUAL_SEQ.
+	 */
+	PMT_VISUAL_ID = 0x8C,
+	/*!
+	 * A parameter of the robot, a struct puck_msg_param. Sent by the
+	 * server to read or set it, the robot answers with PMT_ACK, then
+	 * sends the value in effect back in a PMT_PARAM of its own.
+	 */
+	PMT_PARAM = 0x8D
+};
+
+/*!
+ * The formats of the pixels, each row is cols pixels.
+ */
+enum PUCK_PIXEL_FORMATS {
+	PPF_GREY = 0,	/*!< One byte per pixel */
+	PPF_RGB565 = 1,	/*!< Two bytes per pixel, RRRRRGGG GGGBBBBB */
+	PPF_YUV422 = 2,	/*!< Two bytes per pixel, as sent by the camera */
+	PPF_RGB332 = 3	/*!< One byte per pixel, RRRGGGBB */
+};
+
+/*!
+ * The payload of PMT_VISUAL_BLOB, all the fields are little endian.
+ */
+struct puck_msg_blob {
+	uint16_t count;	/*!< Number of bright pixels, 0 if none */
+	int16_t x;	/*!< Column of the centroid, in 1/16 pixel */
+	int16_t y;	/*!< Row of the centroid, in 1/16 pixel */
+};
+
+/*!
+ * The payload of PMT_POSE (12 bytes), all the fields are little endian.
+ */
+struct puck_msg_pose {
+	int32_t x;	/*!< Position in um, from the start */
+	int32_t y;	/*!< Position in um, from the start */
+	uint16_t theta;	/*!< Heading, 65536 is a full turn, counterclockwise */
+	uint16_t flags;	/*!< ODO_SLIP (0x01) if the wheels slip */
+};
+
+/*!
+ * The payload of PMT_SENSORS (48 bytes), all the fields are little endian.
+ * The sensors are numbered as on the robot, 0 is front right and 7 front
+ * left.
+ */
+struct puck_msg_sensors {
+	uint16_t time;		/*!< Time of the snapshot in ms, it wraps around */
+	int16_t prox[8];	/*!< Reflected light, calibrated and filtered */
+	int16_t ambient[8];	/*!< Ambient light */
+	int16_t acc[3];		/*!< Accelerometer x, y and z, in ADC counts */
+	int32_t steps[2];	/*!< Steps of the left and right wheel */
+};
+
+/*!
+ * The payload of PMT_NAV_WEIGHTS (36 bytes), all the fields are little endian.
+ *
+ * The speed of a wheel, in steps/s, is its bias plus the sum of each
+ * proximity value times its weight, divided by 256. The sensors are
+ * numbered as on the robot, 0 is front right and 7 front left.
+ */
+struct puck_msg_nav {
+	int16_t left[8];	/*!< Weights of the left wheel */
+	int16_t right[8];	/*!< Weights of the right wheel */
+	int16_t bias[2];	/*!< Speeds of the left and right wheel */
+};
+
+/*!
+ * A cycle counter of PMT_STATS. The count and the total only grow and wrap
+ * around, the difference between two messages gives the load.
+ */
+struct puck_msg_stat {
+	uint16_t count;	/*!< Number of runs */
+	uint16_t max;	/*!< Longest run since the last message, in cycles */
+	uint32_t total;	/*!< Cycles of all the runs */
+};
+
+/*!
+ * The payload of PMT_STATS (116 bytes), all the fields are little endian.
+ * The robot runs at 14.7456 M cycles per second.
+ */
+struct puck_msg_stats {
+	uint32_t time;		/*!< Cycles since the start */
+	/*!
+	 * The interrupts: Timer1, Timer3, Timer4 (counted only), Timer5, ADC,
+	 * I2C, UART1 reception and UART1 transmission.
+	 */
+	struct puck_msg_stat isr[8];
+	struct puck_msg_stat loop;	/*!< Passes of the main loop */
+	uint32_t tx_state[8];	/*!< Cycles in each transmission state */
+	/*!
+	 * The longest entry delay of Timer1, Timer2 and Timer3 since the last
+	 * message, in cycles: how long the interrupts of their priority
+	 * waited for the ones above. The fourth one is 0, it pads the
+	 * payload to the alignment of a host.
+	 */
+	uint16_t latency[4];
+};
+
+/*
+ * The robot and a host must agree on the size of the payload.
+ */
+typedef char puck_msg_stats_size[(sizeof(struct puck_msg_stats) == 116)
+		? 1 : -1];
+
+/*!
+ * The payload of PMT_VISUAL_FORMAT.
+ */
+struct puck_msg_format {
+	uint8_t format;	/*!< \ref PUCK_PIXEL_FORMATS */
+	uint8_t bpp;	/*!< Bytes per pixel */
+};
+
+/*!
+ * The start of the payload of PMT_VISUAL_SEQ.
+ */
+struct puck_msg_seq {
+	uint8_t seq;	/*!< Sequence number, it wraps around */
+	uint8_t type;	/*!< Type of the message that follows */
+};
+
+/*!
+ * The payload of PMT_SEQ_ACK.
+ */
+struct puck_msg_seq_ack {
+	uint8_t next;	/*!< Sequence number of the next message expected */
+};
+
+/*!
+ * The parameters of PMT_PARAM. They start with the values of
+ * configuration.h, until they are saved in the data EEPROM of the robot.
+ */
+enum PUCK_PARAMS {
+	PP_MOVING_SPEED = 0,	/*!< Speed without obstacle, steps/s */
+	PP_MOTION_ACCEL = 1,	/*!< Acceleration of the wheels, steps/s^2 */
+	/*!
+	 * Width of the images in pixels. The geometry is at most the one of
+	 * configuration.h, the buffers are sized for it. A change restarts
+	 * the transmission with a PMT_CONFIG.
+	 */
+	PP_IMG_W = 2,
+	PP_IMG_H = 3,		/*!< Height of the images in pixels */
+	PP_IMG_SS = 4,		/*!< Sub-sampling ratio of the images */
+	PP_COUNT		/*!< Number of parameters */
+};
+
+/*!
+ * The flags of PMT_PARAM. Without any from the server, the parameter is
+ * only read.
+ */
+enum PUCK_PARAM_FLAGS {
+	/*!
+	 * The value is set. It is refused if out of range, or if the image
+	 * does not fit the sensor with the other parameters: the server then
+	 * changes the parameter that shrinks the image first.
+	 */
+	PARAM_SET = 0x01,
+	/*!
+	 * All the parameters are saved in the data EEPROM and are loaded at
+	 * the next start.
+	 */
+	PARAM_SAVE = 0x02,
+	/*!
+	 * From the robot: the value set was refused, by the range or by the
+	 * camera, the value is the one still in effect.
+	 */
+	PARAM_REFUSED = 0x80
+};
+
+/*!
+ * The payload of PMT_PARAM (4 bytes), all the fields are little endian.
+ */
+struct puck_msg_param {
+	uint8_t id;	/*!< \ref PUCK_PARAMS */
+	uint8_t flags;	/*!< \ref PUCK_PARAM_FLAGS */
+	int16_t value;	/*!< The value set, or in effect from the robot */
+};
+
+/*!
+ * The payload of PMT_SLOT (8 bytes), all the fields are little endian.
+ *
+ * The slots of the robots repeat every period. A robot starts a message only
+ * if it ends before its slot does, at 115200 baud, and sends at most budget
+ * images per slot. The server sends the message again to correct the drift
+ * of the clock of the robot, or with a period of 0 to let it send at any
+ * time.
+ */
+struct puck_msg_slot {
+	uint8_t id;		/*!< The number of the robot in the swarm */
+	uint8_t budget;		/*!< Images per slot */
+	uint16_t period;	/*!< Period of the slots in ms, at most 32767 */
+	/*!
+	 * Time from this message to the slot in ms, less than the period
+	 * (the slots repeat, a longer one is taken modulo the period).
+	 */
+	uint16_t start;
+	uint16_t length;	/*!< Length of the slot in ms */
+};
+
+/*!
+ * The start of the payload of PMT_VISUAL_ID.
+ */
+struct puck_msg_id {
+	uint8_t id;	/*!< The number of the robot, from its PMT_SLOT */
+	uint8_t type;	/*!< Type of the message that follows */
+};
+
+#endif /* PUCOM_EXT_H_ */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,219 @@
+/*!
+ * \file	scheduler.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * The events are not posted by the drivers, which stay independent of this
+ * project. Every interrupt wakes the core from idle mode and the scheduler
+ * then compares the state of the drivers with the one it saw last: the
+ * proximity cycle counter, the camera ready flag and row counter and the UART1
+ * counters.
+ * Since the ADC interrupts every 119 us and Timer1 every 1 ms, an event is
+ * seen at most 1 ms after it happened.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <p30F6014A.h>
+
+#include <motor_led/e_epuck_ports.h>
+#include <motor_led/e_led.h>
+#include <a_d/advance_ad_scan/e_ad_conv.h>
+#include <uart/e_uart_char.h>
+#include <camera/fast_2_timer/e_poxxxx.h>
+#include <profile/e_profile.h>
+
+#include "configuration.h"
+#include "scheduler.h"
+
+static volatile unsigned int sched_ms = 0;	/*!< Time since sched_init() */
+static volatile unsigned int posted = 0;	/*!< Events from sched_post() */
+
+static unsigned int last_prox_cycle;	/*!< Last seen proximity cycle */
+static unsigned int last_rx_cnt;	/*!< Last seen UART1 reception count */
+static int was_img_ready;		/*!< Last seen camera ready flag */
+static unsigned int last_row;		/*!< Last seen camera row */
+static int last_tx_free;		/*!< Last seen free UART1 segments */
+static int was_sending;			/*!< Last seen UART1 sending state */
+static unsigned int last_rx2_cnt;	/*!< Last seen UART2 reception count */
+static int was_sending2;		/*!< Last seen UART2 sending state */
+
+/*!
+ * The system tick, it also dims the LEDs.
+ */
+void __attribute__((interrupt, auto_psv))
+_T1Interrupt(void)
+{
+	E_PROF_ENTER();
+	E_PROF_LATENCY(E_PROF_LAT_T1, TMR1);
+
+	IFS0bits.T1IF = 0;
+	sched_ms++;
+	e_led_tick();
+	E_PROF_EXIT(E_PROF_T1);
+}
+
+/*!
+ * Collects the events that fired since the last call.
+ */
+static unsigned int poll_events(void)
+{
+	unsigned int events, ipl, tmp;
+
+	ipl = SRbits.IPL;
+	SRbits.IPL = IRQ_PRIO_MASK;
+	events = posted;
+	posted = 0;
+	SRbits.IPL = ipl;
+
+	tmp = e_ad_prox_cycle;
+	if (tmp != last_prox_cycle) {
+		last_prox_cycle = tmp;
+		events |= EV_PROX;
+	}
+
+	tmp = e_poxxxx_is_img_ready();
+	if (tmp && !was_img_ready)
+		events |= EV_IMG;
+	was_img_ready = tmp;
+
+	tmp = e_poxxxx_rows_done();
+	if (tmp != last_row) {
+		last_row = tmp;
+		events |= EV_ROW;
+	}
+
+	tmp = U1RXRcvCnt;
+	if (tmp != last_rx_cnt) {
+		last_rx_cnt = tmp;
+		events |= EV_RX;
+	}
+
+	tmp = e_uart1_tx_free();
+	if ((int)tmp > last_tx_free)
+		events |= EV_TX;
+	last_tx_free = tmp;
+
+	tmp = e_uart1_sending();
+	if (!tmp && was_sending)
+		events |= EV_TX;
+	was_sending = tmp;
+
+	tmp = U2RXRcvCnt;
+	if (tmp != last_rx2_cnt) {
+		last_rx2_cnt = tmp;
+		events |= EV_RX2;
+	}
+
+	tmp = e_uart2_sending();
+	if (!tmp && was_sending2)
+		events |= EV_TX2;
+	was_sending2 = tmp;
+
+	return events;
+}
+
+/*!
+ * Starts the system tick on Timer 1, at the priority set by irq_init().
+ */
+void sched_init(void)
+{
+	T1CON = 0;
+	TMR1 = 0;
+	PR1 = (unsigned int)MILLISEC - 1;	/* 1 ms with a 1:1 prescaler */
+	IFS0bits.T1IF = 0;
+	IEC0bits.T1IE = 1;
+	T1CONbits.TON = 1;
+
+	last_prox_cycle = e_ad_prox_cycle;
+	last_rx_cnt = U1RXRcvCnt;
+	last_rx2_cnt = U2RXRcvCnt;
+	last_tx_free = e_uart1_tx_free();
+}
+
+/*!
+ * Gives the time since sched_init().
+ *
+ * \return	The time in ms, it wraps around after about 65 s.
+ */
+unsigned int sched_time(void)
+{
+	return sched_ms;
+}
+
+/*!
+ * Fires events, the tasks waiting for them run in the next pass.
+ *
+ * \param	events	The events to fire, usually \ref EV_USER.
+ */
+void sched_post(unsigned int events)
+{
+	unsigned int ipl;
+
+	ipl = SRbits.IPL;
+	if (ipl < IRQ_PRIO_MASK)
+		SRbits.IPL = IRQ_PRIO_MASK;
+	posted |= events;
+	SRbits.IPL = ipl;
+}
+
+/*!
+ * Runs the tasks forever.
+ *
+ * In each pass, the tasks run in the order of the array. When no task had
+ * to run, the core is put into idle mode until the next interrupt. The
+ * passes that ran a task are measured in e_prof_loop.
+ *
+ * \param	tasks	The tasks.
+ * \param	count	The number of tasks.
+ */
+void sched_run(struct sched_task *tasks, int count)
+{
+	unsigned int events, fired, now;
+	int i, ran;
+#if DBG_INCLUDE_PROFILE == 1
+	unsigned long start;
+#endif	/* DBG_INCLUDE_PROFILE */
+
+	for (i = 0; i < count; i++)
+		tasks[i].last = sched_time();
+
+	while (1) {
+#if DBG_INCLUDE_PROFILE == 1
+		start = e_prof_time();
+#endif	/* DBG_INCLUDE_PROFILE */
+		events = poll_events();
+		now = sched_time();
+		ran = 0;
+
+		for (i = 0; i < count; i++) {
+			fired = events & tasks[i].events;
+			if (fired || ((tasks[i].period != 0) &&
+					(now - tasks[i].last >= tasks[i].period))) {
+				tasks[i].last = now;
+				tasks[i].run(fired);
+				ran = 1;
+			}
+		}
+
+#if DBG_INCLUDE_PROFILE == 1
+		if (ran)
+			e_prof_add(&e_prof_loop, e_prof_time() - start);
+#endif	/* DBG_INCLUDE_PROFILE */
+		if (!ran)
+			Idle();
+	}
+}
+
+/*!
+ * @}
+ */
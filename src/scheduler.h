@@ -0,0 +1,61 @@
+/*!
+ * \file	scheduler.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * A cooperative scheduler: each task runs when one of its events fired or
+ * when its period expired, the core idles in between.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+/*!
+ * The events a task can wait for.
+ */
+enum SCHED_EVENTS {
+	EV_PROX = 0x01,		/*!< A proximity cycle is complete */
+	EV_IMG = 0x02,		/*!< The camera finished an image */
+	EV_RX = 0x04,		/*!< Bytes were received on UART1 */
+	EV_TX = 0x08,		/*!< UART1 segments were sent */
+	EV_ROW = 0x10,		/*!< The camera finished a row */
+	EV_USER = 0x20,		/*!< Posted with sched_post() */
+	EV_RX2 = 0x40,		/*!< Bytes were received on UART2 */
+	EV_TX2 = 0x80		/*!< UART2 sent its buffer */
+};
+
+/*!
+ * A task of the scheduler.
+ */
+struct sched_task {
+	/*!
+	 * The function of the task, it is given the events that fired since
+	 * the last run (0 if it runs because of its period).
+	 */
+	void (*run)(unsigned int events);
+	unsigned int events;	/*!< The events the task waits for */
+	unsigned int period;	/*!< Maximum time between two runs in ms, 0 if none */
+	unsigned int last;	/*!< Time of the last run, used by the scheduler */
+};
+
+void sched_init(void);
+unsigned int sched_time(void);
+void sched_post(unsigned int events);
+void sched_run(struct sched_task *tasks, int count);
+
+#endif /* SCHEDULER_H_ */
+
+/*!
+ * @}
+ */
@@ -0,0 +1,122 @@
+/*!
+ * \file	slot.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * The slot is kept as the time of its next start on the clock of the
+ * scheduler, which moves on by one period each time the slot is over. The
+ * robots do not share a clock, the server gives each one the time to its
+ * slot and sends it again before the clocks drift apart.
+ *
+ * Until the first PMT_SLOT the robot sends at any time, so it also works
+ * with a server that knows nothing of the swarm.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include "configuration.h"
+#include "scheduler.h"
+#include "slot.h"
+
+#if TX_SWARM == 1
+
+/*!
+ * Time on the line of a byte at 115200 baud, in us (10 bits).
+ */
+#define SLOT_BYTE_US	87
+
+static struct puck_msg_slot slot;	/*!< period 0 if none was assigned */
+static unsigned int slot_start;		/*!< Start of the current slot */
+static unsigned int slot_images;	/*!< Images sent in the current slot */
+
+/*!
+ * Takes a slot from the server, it starts start ms from now.
+ *
+ * \param	msg	The payload of the PMT_SLOT.
+ */
+void slot_set(const struct puck_msg_slot *msg)
+{
+	slot = *msg;
+	if (slot.period > 0x7FFF)
+		slot.period = 0x7FFF;
+	if (slot.length > slot.period)
+		slot.length = slot.period;
+	if (slot.period != 0)
+		slot.start %= slot.period;	/* elapsed fits an int */
+	slot_start = sched_time() + slot.start;
+	slot_images = 0;
+}
+
+/*!
+ * Checks whether a message may start now: the slot is open and the message
+ * is sent before it ends.
+ *
+ * \param	bytes	The length of the message, header included.
+ * \param	image	Whether the message is an image, it must fit the
+ *			budget of the slot.
+ *
+ * \return	Non-zero if the message may start, always without a slot.
+ */
+int slot_fits(unsigned int bytes, int image)
+{
+	int elapsed;
+
+	if (slot.period == 0)
+		return 1;
+	elapsed = sched_time() - slot_start;
+	while (elapsed >= (int)slot.period) {
+		slot_start += slot.period;
+		elapsed -= slot.period;
+		slot_images = 0;
+	}
+	if (elapsed < 0)
+		return 0;	/* the first slot is still to come */
+	if (image && (slot_images >= slot.budget))
+		return 0;
+	return elapsed + (__builtin_muluu(bytes, SLOT_BYTE_US) + 999) / 1000
+			<= slot.length;
+}
+
+/*!
+ * Counts an image sent in the current slot.
+ */
+void slot_count_image(void)
+{
+	slot_images++;
+}
+
+/*!
+ * Turns an image message into a PMT_VISUAL_ID, once the robot has a slot.
+ *
+ * \param	hdr	The header of the message, it becomes the header of the
+ *			PMT_VISUAL_ID.
+ * \param	id	The start of the payload to fill in, it goes before the
+ *			payload of the message.
+ *
+ * \return	Non-zero if the message was marked.
+ */
+int slot_mark(struct puck_msg_hdr *hdr, struct puck_msg_id *id)
+{
+	if (slot.period == 0)
+		return 0;
+	id->id = slot.id;
+	id->type = hdr->type;
+	hdr->type = PMT_VISUAL_ID;
+	hdr->len += sizeof(*id);
+	return 1;
+}
+
+#endif	/* TX_SWARM */
+
+/*!
+ * @}
+ */
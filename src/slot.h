@@ -0,0 +1,45 @@
+/*!
+ * \file	slot.h
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Time slots of a swarm: several robots share the server, each one only
+ * sends in the slot the server gave it with PMT_SLOT.
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#ifndef SLOT_H_
+#define SLOT_H_
+
+#include <pucom.h>
+#include "configuration.h"
+#include "pucom_ext.h"
+
+#if TX_SWARM == 1
+void slot_set(const struct puck_msg_slot *msg);
+int slot_fits(unsigned int bytes, int image);
+void slot_count_image(void);
+int slot_mark(struct puck_msg_hdr *hdr, struct puck_msg_id *id);
+#else
+/*
+ * Without the swarm, the robot sends at any time.
+ */
+#define slot_fits(bytes, image)	1
+#define slot_count_image()
+#endif	/* TX_SWARM */
+
+#endif /* SLOT_H_ */
+
+/*!
+ * @}
+ */
@@ -1 +1 @@
-/*! * \addtogroup puck2bt * @{ */#include "utility.h"#include <stdlib.h>	/* for random numbers */#include <math.h>#include <motor_led/e_epuck_ports.h>#include <uart/e_uart_char.h>#include <motor_led/e_motors.h>void wait(long num) {	long i;	for(i=0;i<num;i++);}void myWait(long milli){	long i;	for(i=0;i<(milli*1500);i++);}int get_selector() {	return SELECTOR0 + 2*SELECTOR1 + 4*SELECTOR2 + 8*SELECTOR3;}void setLED(int LEDnum, int state){	if(LEDnum == 0)		LED0 = state;	if(LEDnum == 1)		LED1 = state;	if(LEDnum == 2)		LED2 = state;	if(LEDnum == 3)		LED3 = state;	if(LEDnum == 4)		LED4 = state;	if(LEDnum == 5)		LED5 = state;	if(LEDnum == 6)		LED6 = state;	if(LEDnum == 7)		LED7 = state;}int errorPercent = 1;	/* problem with 0 */void setErrorPercent(int input){	errorPercent = input;}void setSpeeds(int leftSpeed, int rightSpeed){	double chosenErrorLeft = ((double) ((rand() % (2*errorPercent))-errorPercent)) / 100.0;	int actualLeftSpeed = ((int) (((double) leftSpeed) * (1.0 + chosenErrorLeft)));	double chosenErrorRight = ((double) ((rand() % (2*errorPercent))-errorPercent)) / 100.0;	int actualRightSpeed = ((int) (((double) rightSpeed) * (1.0 + chosenErrorRight)));	e_set_speed_left(actualLeftSpeed);	e_set_speed_right(actualRightSpeed);}void allRedLEDsOff(){	LED0 = 0;	LED1 = 0;	LED2 = 0;	LED3 = 0;	LED4 = 0;	LED5 = 0;	LED6 = 0;	LED7 = 0;}void allRedLEDsOn(){	LED0 = 1;	LED1 = 1;	LED2 = 1;	LED3 = 1;	LED4 = 1;	LED5 = 1;	LED6 = 1;	LED7 = 1;}/*! * @} */
\ No newline at end of file
+/*! * \addtogroup puck2bt * @{ */#include "utility.h"#include <stdlib.h>	/* for random numbers */#include <motor_led/e_epuck_ports.h>#include <uart/e_uart_char.h>#include <motor_led/e_motors.h>#include "scheduler.h"void wait(long num) {	long i;	for(i=0;i<num;i++);}/*! * Waits on the tick of the scheduler, the core idles in between and the * interrupts go on. * * \param	milli	The time in ms. * * \warning	sched_init() must have been called, and not from an interrupt. */void myWait(long milli){	unsigned int last = sched_time(), now;	while (milli > 0) {		Idle();		now = sched_time();		milli -= now - last;		last = now;	}}int get_selector() {	return SELECTOR0 + 2*SELECTOR1 + 4*SELECTOR2 + 8*SELECTOR3;}void setLED(int LEDnum, int state){	if(LEDnum == 0)		LED0 = state;	if(LEDnum == 1)		LED1 = state;	if(LEDnum == 2)		LED2 = state;	if(LEDnum == 3)		LED3 = state;	if(LEDnum == 4)		LED4 = state;	if(LEDnum == 5)		LED5 = state;	if(LEDnum == 6)		LED6 = state;	if(LEDnum == 7)		LED7 = state;}int errorPercent = 1;	/* problem with 0 */void setErrorPercent(int input){	errorPercent = input;}/*! * Gives a speed with a random error of up to errorPercent. */static int speedError(int speed){	int error = (rand() % (2*errorPercent)) - errorPercent;	return speed + (int)(__builtin_mulss(speed, error) / 100);}void setSpeeds(int leftSpeed, int rightSpeed){	e_set_speed_left(speedError(leftSpeed));	e_set_speed_right(speedError(rightSpeed));}/*! * Moves straight on, the function returns at once and the motors stop at * the end of the distance (see moveDone()). * * \param	dist	The distance in mm, negative to move backwards. * \param	speed	The speed in steps/s. */void move(int dist, int speed){	int steps = (__builtin_mulss(dist, STEPS_PER_MM_Q8) + 128) >> 8;	e_move_left(steps, speed);	e_move_right(steps, speed);}/*! * Moves forwards, see move(). * * \param	dist	The distance in mm, its sign is ignored. * \param	speed	The speed in steps/s. */void moveForward(int dist, int speed){	move(abs(dist), speed);}/*! * Turns on the spot, the function returns at once and the motors stop at * the end of the turn (see moveDone()). * * \param	degrees	The angle, positive to turn left. * \param	speed	The speed of the wheels in steps/s. */void turn(int degrees, int speed){	int steps = (__builtin_mulss(degrees, STEPS_PER_DEG_Q8) + 128) >> 8;	e_move_left(-steps, speed);	e_move_right(steps, speed);}/*! * Checks the end of the last move() or turn(). * * \return	Non-zero once both wheels made their steps. */int moveDone(){	return !e_motors_moving();}/*! * Waits for a character from the Bluetooth link (UART1), the core idles in * between. * * \warning	Not while the transmission FSM reads UART1. */char btcomGetCharacter(){	char c;	while (!e_ischar_uart1())		Idle();	e_getchar_uart1(&c);	return c;}void allRedLEDsOff(){	LED0 = 0;	LED1 = 0;	LED2 = 0;	LED3 = 0;	LED4 = 0;	LED5 = 0;	LED6 = 0;	LED7 = 0;}void allRedLEDsOn(){	LED0 = 1;	LED1 = 1;	LED2 = 1;	LED3 = 1;	LED4 = 1;	LED5 = 1;	LED6 = 1;	LED7 = 1;}/*! * @} */
\ No newline at end of file
@@ -17,19 +17,28 @@
  * @{
  */
 
+#ifndef M_PI
+#define M_PI		3.14159265358979323846
+#endif
+
+/*
+ * Geometry of the robot.
+ */
+#define WHEEL_DIAMETER	41.0	/*!< The wheel diameter in mm */
+#define WHEEL_DISTANCE	53.0	/*!< The distance between the wheels in mm */
+#define STEPS_PER_REV	1000	/*!< Motor steps per wheel revolution */
 /*!
- * Checks the proximity sensors for obstacles on the right (seen as the robot).
+ * Motor steps per mm of wheel travel.
  */
-#define PATH_OBSTRUCTED_RIGHT()	((prox_values[0] > 300) ||	\
-				 (prox_values[1] > 300) ||	\
-				 (prox_values[2] > 1500))
-
+#define STEPS_PER_MM	(STEPS_PER_REV / (M_PI * WHEEL_DIAMETER))
 /*!
- * Checks the proximity sensors for obstacles on the left (seen as the robot).
+ * Motor steps per mm, and steps of each wheel per degree of a turn on the
+ * spot, in 1/256 steps. They are folded by the compiler, the functions
+ * only multiply integers.
  */
-#define PATH_OBSTRUCTED_LEFT()	((prox_values[7] > 300) ||	\
-				 (prox_values[6] > 300) ||	\
-				 (prox_values[5] > 1500))
+#define STEPS_PER_MM_Q8		((int)(STEPS_PER_MM * 256.0 + 0.5))
+#define STEPS_PER_DEG_Q8	((int)(M_PI * WHEEL_DISTANCE / 360.0	\
+					* STEPS_PER_MM * 256.0 + 0.5))
 
 void wait(long num);
 void myWait(long milli);
@@ -42,7 +51,8 @@ void setErrorPercent(int input);
 void setSpeeds(int leftSpeed, int rightSpeed);
 void moveForward(int dist, int speed);
 void move(int dist, int speed);
-void turn(double degrees, int speed);
+void turn(int degrees, int speed);
+int moveDone();
 
 
 
@@ -0,0 +1,451 @@
+/*!
+ * \file	puck_sim.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Replay of a trace through the algorithms of the robot, run on the host.
+ * It takes the modules that do not touch the registers as they are: the
+ * delta coding, the navigation, the capture policy and the image processing
+ * (src/modules/image). The assembly of the robot has a C version here, with
+ * the same 16 bit results, and so have the few functions of the drivers they
+ * call. The state machines of main.c and the drivers stay on the robot.
+ *
+ * The trace is a sequence of pucom messages, each one its struct
+ * puck_msg_hdr and its payload, as written by pucom_bench; a server can add
+ * its PMT_NAV_WEIGHTS. The images are grayscale, their geometry comes from
+ * the last PMT_CONFIG:
+ *	- PMT_VISUAL and PMT_VISUAL_DELTA (decoded against the previous
+ *	  image): the image goes through the capture policy, as a delta
+ *	  against the last image sent, the column sums and the blob,
+ *	- PMT_SENSORS: the proximity values give the wheel speeds, its time is
+ *	  the clock of the policy,
+ *	- PMT_NAV_WEIGHTS: the weights of the navigation from then on,
+ *	- the other messages are skipped.
+ *
+ * The trace is replayed the given number of times, the statistics are of all
+ * the runs. With -p the images go through the capture policy, otherwise they
+ * are all sent and the policy time is 0. The report goes to the standard
+ * error, and a CSV line to the standard output:
+ *
+ *	label,cols,rows,images,sent,raw_bytes,delta_bytes,delta_us,decode_us,
+ *	profile_us,blob_us,policy_us,nav_ns
+ *
+ * where the times are the mean per call on the host. The ratio of two times,
+ * e.g. of two versions of a function, also holds on the robot as long as the
+ * memory accesses dominate.
+ *
+ * Before the replay, the line of the camera (e_line.c) is checked for every
+ * geometry that PMT_PARAM allows, in both bytes per pixel: the count of the
+ * REPEAT and the loop of the HSYNC interrupt must give 8 cycles per byte.
+ *
+ * Built with:
+ *
+ *	cc -O2 -Wall -DIMG_POLICY=1 -I<pucom> -Isrc -Isrc/modules \
+ *		-o puck_sim tools/puck_sim.c src/img_codec.c src/navigation.c \
+ *		src/img_policy.c src/modules/image/e_image.c \
+ *		src/modules/camera/fast_2_timer/e_line.c
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <pucom.h>
+#include <camera/fast_2_timer/e_poxxxx.h>
+#include <image/e_image.h>
+#include "pucom_ext.h"
+#include "configuration.h"
+#include "scheduler.h"
+#include "img_codec.h"
+#include "img_policy.h"
+#include "navigation.h"
+
+/*!
+ * Largest image of a trace in bytes, and its largest side.
+ */
+#define SIM_IMG_MAX	65536
+#define SIM_SIDE_MAX	256
+
+#if IMG_POLICY != 1
+#error "puck_sim is built with -DIMG_POLICY=1"
+#endif
+
+/*!
+ * A time measured on the host, in ns.
+ */
+struct sim_timer {
+	double total;
+	unsigned long count;
+};
+
+static unsigned int sim_time;	/*!< Time of the last PMT_SENSORS, in ms */
+static int sim_running;		/*!< The last wheel speeds were not 0 */
+static unsigned int cols, rows;	/*!< Geometry of the last PMT_CONFIG */
+static int policy;		/*!< The images go through the policy (-p) */
+
+static struct sim_timer t_delta, t_decode, t_profile, t_blob, t_policy, t_nav;
+static unsigned long images, sent;
+static double raw_bytes, delta_bytes;
+
+/*
+ * The functions of the robot the modules call.
+ */
+
+unsigned int sched_time(void)
+{
+	return sim_time;
+}
+
+int e_motors_running(void)
+{
+	return sim_running;
+}
+
+/*
+ * The line of the camera, as the HSYNC interrupt sees it. The offsets of
+ * its loops are their numbers here.
+ */
+
+int _poxxxx_row;
+const int _poxxxx_loop_offsets[4] = {0, 1, 2, 3};
+
+extern int _poxxxx_pixel_cnt, _poxxxx_skip_cnt, _poxxxx_loop;
+
+/*
+ * The assembly of the robot, in C. The sums and the counts are 16 bit, as
+ * on the robot; the MAC accumulates in 40 bits, a long long here.
+ */
+
+long nav_dot(const int16_t *w, const int *x, int n)
+{
+	long long a = 0;
+
+	while (n-- > 0)
+		a += (long long)*w++ * (int16_t)*x++;
+	return (int32_t)a;
+}
+
+void e_img_col_sum(const char *img, int width, int height, unsigned int *sums)
+{
+	const unsigned char *p = (const unsigned char *)img;
+	int x, y;
+
+	for (x = 0; x < width; x++)
+		sums[x] = 0;
+	for (y = 0; y < height; y++)
+		for (x = 0; x < width; x++)
+			sums[x] = (uint16_t)(sums[x] + *p++);
+}
+
+void e_img_col_count(const char *img, int width, int height,
+		unsigned int thr, int *counts)
+{
+	const unsigned char *p = (const unsigned char *)img;
+	int x, y;
+
+	for (x = 0; x < width; x++)
+		counts[x] = 0;
+	for (y = 0; y < height; y++)
+		for (x = 0; x < width; x++)
+			counts[x] = (int16_t)(counts[x] + (*p++ >= thr));
+}
+
+void e_img_row_count(const char *img, int width, int height,
+		unsigned int thr, int *counts)
+{
+	const unsigned char *p = (const unsigned char *)img;
+	int x, y, n;
+
+	for (y = 0; y < height; y++) {
+		n = 0;
+		for (x = 0; x < width; x++)
+			n = (int16_t)(n + (*p++ >= thr));
+		counts[y] = n;
+	}
+}
+
+long e_img_moment(const int *v, int n, long *sum)
+{
+	long long a = 0, b = 0;
+	int i;
+
+	for (i = 0; i < n; i++) {
+		a += (long long)i * (int16_t)v[i];
+		b += (int16_t)v[i];
+	}
+	*sum = (int32_t)b;
+	return (int32_t)a;
+}
+
+/*!
+ * Gives a monotonic time in ns.
+ */
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void add_time(struct sim_timer *t, double start)
+{
+	t->total += now() - start;
+	t->count++;
+}
+
+static double mean_us(const struct sim_timer *t)
+{
+	return (t->count > 0) ? t->total / t->count / 1000.0 : 0.0;
+}
+
+/*!
+ * Runs an image through the algorithms of the robot.
+ *
+ * \param	img	The image, cols x rows bytes.
+ * \param	ref	The last image sent, NULL if none.
+ *
+ * \return	Whether the image is sent.
+ */
+static int run_img(const uint8_t *img, const uint8_t *ref)
+{
+	static uint8_t code[SIM_IMG_MAX], back[SIM_IMG_MAX];
+	static unsigned int sums[SIM_SIDE_MAX];
+	static int work[SIM_SIDE_MAX];
+	struct e_img_blob blob;
+	size_t size = cols * rows, len;
+	double start;
+	int send = 1;
+
+	images++;
+	if (policy) {
+		start = now();
+		send = img_policy_check((const char *)img, cols, rows);
+		add_time(&t_policy, start);
+	}
+	if (!send)
+		return 0;
+	sent++;
+
+	raw_bytes += size;
+	if (ref != NULL) {
+		/* the code is at most half of the image, like IMG_DELTA_MAX */
+		start = now();
+		len = img_delta_encode(code, size / 2, img, ref, size);
+		add_time(&t_delta, start);
+		if (len != 0) {
+			start = now();
+			memcpy(back, ref, size);
+			if (img_delta_decode(back, size, code, len) != 0
+					|| memcmp(back, img, size) != 0)
+				fprintf(stderr, "image %lu: the delta does not "
+						"decode\n", images);
+			add_time(&t_decode, start);
+		}
+		delta_bytes += (len != 0) ? len : size;
+	}
+	else
+		delta_bytes += size;
+
+	start = now();
+	e_img_col_sum((const char *)img, cols, rows, sums);
+	add_time(&t_profile, start);
+	start = now();
+	e_img_blob((const char *)img, cols, rows, IMG_BLOB_THRESHOLD, &blob,
+			work);
+	add_time(&t_blob, start);
+	return 1;
+}
+
+/*!
+ * Replays a trace once.
+ *
+ * \return	0 once the trace is replayed, -1 if it is not valid.
+ */
+static int replay(FILE *f)
+{
+	static uint8_t payload[SIM_IMG_MAX], img[SIM_IMG_MAX], ref[SIM_IMG_MAX];
+	struct puck_msg_hdr hdr;
+	struct puck_msg_sensors sens;
+	int prox[8], left, right, i, has_img = 0, has_ref = 0;
+	double start;
+
+	rewind(f);
+	img_policy_init();
+	while (fread(&hdr, sizeof(hdr), 1, f) == 1) {
+		if ((hdr.len > sizeof(payload))
+				|| (fread(payload, 1, hdr.len, f) != hdr.len))
+			return -1;
+		switch (hdr.type) {
+		case PMT_CONFIG:
+			cols = ((struct puck_msg_config *)payload)->cols;
+			rows = ((struct puck_msg_config *)payload)->rows;
+			if ((cols > SIM_SIDE_MAX) || (rows > SIM_SIDE_MAX))
+				return -1;
+			has_img = has_ref = 0;
+			break;
+		case PMT_VISUAL:
+			if (hdr.len != cols * rows)
+				break;	/* not grayscale */
+			memcpy(img, payload, hdr.len);
+			has_img = 1;
+			if (run_img(img, has_ref ? ref : NULL)) {
+				memcpy(ref, img, hdr.len);
+				has_ref = 1;
+			}
+			break;
+		case PMT_VISUAL_DELTA:
+			/* the trace has the deltas against the images sent */
+			if (!has_img || (img_delta_decode(img, cols * rows,
+					payload, hdr.len) != 0))
+				break;
+			if (run_img(img, has_ref ? ref : NULL)) {
+				memcpy(ref, img, cols * rows);
+				has_ref = 1;
+			}
+			break;
+		case PMT_SENSORS:
+			if (hdr.len != sizeof(sens))
+				break;
+			memcpy(&sens, payload, sizeof(sens));
+			sim_time = sens.time;
+			for (i = 0; i < 8; i++)
+				prox[i] = sens.prox[i];
+			start = now();
+			nav_speeds(prox, &left, &right);
+			add_time(&t_nav, start);
+			sim_running = (left != 0) || (right != 0);
+			break;
+		case PMT_NAV_WEIGHTS:
+			if (hdr.len == sizeof(struct puck_msg_nav))
+				nav_set_weights((struct puck_msg_nav *)payload);
+			break;
+		}
+	}
+	return 0;
+}
+
+/*!
+ * Checks the line of the camera for a geometry. The sensors sub-sample by 1,
+ * 2 or 4 themselves, the interrupt skips the rest of the pixels.
+ *
+ * \return	0 if the line is right, -1 if not.
+ */
+static int check_line(int w, int h, int ss, int sensor_ss, int bpp)
+{
+	/* cycles per pixel of each loop, see e_interrupt.S */
+	const long loop_cycles[4] = {8, 9, 16, 17};
+	int pbp = ss / sensor_ss - 1;
+	long cycles;
+
+	if (e_poxxxx_apply_timer_config(h, w, bpp, pbp, pbp) != 0) {
+		fprintf(stderr, "line %dx%d/%d, %d bpp: refused\n", w, h, ss,
+				bpp);
+		return -1;
+	}
+	cycles = loop_cycles[_poxxxx_loop];
+	if (_poxxxx_loop & 1)
+		cycles += _poxxxx_skip_cnt;
+	if ((_poxxxx_pixel_cnt != w) || (_poxxxx_row != h)
+			|| (_poxxxx_loop != (bpp - 1) * 2 + (pbp != 0))
+			|| (cycles != 8L * bpp * (1 + pbp))) {
+		fprintf(stderr, "line %dx%d/%d, %d bpp: %d pixels, loop %d, "
+				"%ld cycles per pixel\n", w, h, ss, bpp,
+				_poxxxx_pixel_cnt, _poxxxx_loop, cycles);
+		return -1;
+	}
+	return 0;
+}
+
+/*!
+ * Checks the line of every geometry of PMT_PARAM (see params.c).
+ *
+ * \return	0 if all the lines are right, -1 if not.
+ */
+static int check_lines(void)
+{
+	static const int sensor_ss[3] = {1, 2, 4};
+	int w, ss, bpp, i, n = 0, err = 0;
+
+	for (ss = 1; ss <= 16; ss++)
+		for (w = 1; (w <= IMG_W) && (w * ss <= ARRAY_WIDTH); w++)
+			for (bpp = 1; bpp <= 2; bpp++)
+				for (i = 0; i < 3; i++) {
+					if (ss % sensor_ss[i] != 0)
+						continue;
+					if (check_line(w, IMG_H, ss,
+							sensor_ss[i], bpp) < 0)
+						err = -1;
+					n++;
+				}
+	fprintf(stderr, "%d lines of the camera checked%s\n", n,
+			err ? ", some are wrong" : "");
+	return err;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long repeats = 1, n;
+	FILE *f;
+
+	if ((argc > 1) && (strcmp(argv[1], "-p") == 0)) {
+		policy = 1;
+		argc--;
+		argv++;
+	}
+	if ((argc < 2) || (argc > 4)) {
+		fprintf(stderr, "usage: %s [-p] <trace> [repeats] [label]\n",
+				argv[0]);
+		return 2;
+	}
+	if (check_lines() < 0)
+		return 1;
+	if (argc > 2)
+		repeats = strtoul(argv[2], NULL, 0);
+	f = fopen(argv[1], "rb");
+	if (f == NULL) {
+		perror(argv[1]);
+		return 1;
+	}
+	for (n = 0; n < repeats; n++) {
+		if (replay(f) < 0) {
+			fprintf(stderr, "%s: not a valid trace\n", argv[1]);
+			return 1;
+		}
+	}
+	fclose(f);
+
+	fprintf(stderr, "%ux%u: %lu images, %lu sent, delta %.1f %% of the "
+			"raw bytes\n", cols, rows, images, sent,
+			(raw_bytes > 0.0) ? delta_bytes * 100.0 / raw_bytes
+				: 0.0);
+	fprintf(stderr, "per call (us): delta %.2f, decode %.2f, profile "
+			"%.2f, blob %.2f, policy %.2f, navigation %.3f\n",
+			mean_us(&t_delta), mean_us(&t_decode),
+			mean_us(&t_profile), mean_us(&t_blob),
+			mean_us(&t_policy), mean_us(&t_nav));
+	printf("%s,%u,%u,%lu,%lu,%.0f,%.0f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f\n",
+			(argc > 3) ? argv[3] : "", cols, rows, images, sent,
+			raw_bytes, delta_bytes, mean_us(&t_delta),
+			mean_us(&t_decode), mean_us(&t_profile),
+			mean_us(&t_blob), mean_us(&t_policy),
+			mean_us(&t_nav) * 1000.0);
+	return 0;
+}
+
+/*!
+ * @}
+ */
@@ -0,0 +1,433 @@
+/*!
+ * \file	pucom_bench.c
+ * \date	2026-10-14
+ * \ingroup	puck2bt
+ *
+ * \author	Darius Kellermann <darius.kellermann@smail.fh-koeln.de>
+ *
+ * \copyright	This file is part of a project that was conducted in the context
+ * 		of the master course "Special Aspects of Autonomous Mobile
+ * 		Systems" at the Cologne University of Applied Sciences.
+ *
+ * Benchmark of the pucom link, run on the host in place of the server. It
+ * acknowledges every message of the robot like the server does, the
+ * PMT_VISUAL_SEQ with PMT_SEQ_ACK, and reports after the given time:
+ *	- the images per second and the bytes per second,
+ *	- the histogram of the round trips, from the PMT_ACK sent to the first
+ *	  byte of the payload received,
+ *	- the fraction of the line time without a character, at BENCH_BAUD
+ *	  (negative if the line is faster, e.g. on a pseudo terminal).
+ *
+ * The robot runs the program built with DBG_BENCHMARK. The geometry comes
+ * from its PMT_CONFIG, so a sweep of IMG_W, IMG_H and IMG_SS is one build
+ * and one run per geometry, each run appends a CSV line to the standard
+ * output:
+ *
+ *	label,cols,rows,seconds,images,images/s,bytes/s,idle,rtt_min_ms,
+ *	rtt_median_ms,rtt_p95_ms,rtt_max_ms
+ *
+ * Given a trace file, the messages received are also saved in it, the
+ * PMT_VISUAL_SEQ and PMT_VISUAL_ID as the message they carry, to be replayed
+ * by puck_sim.
+ *
+ * Built with:
+ *
+ *	cc -O2 -Wall -I<pucom> -Isrc -o pucom_bench tools/pucom_bench.c
+ */
+
+/*!
+ * \addtogroup puck2bt
+ * @{
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/select.h>
+
+#include <pucom.h>
+#include "pucom_ext.h"
+
+/*!
+ * Baud rate of UART1 on the robot.
+ */
+#define BENCH_BAUD	115200
+/*!
+ * Bits per character on the line: start, 8 data and stop bit.
+ */
+#define BENCH_CHAR_BITS	10
+/*!
+ * Width of a bin of the histogram in ms, and number of bins. The last bin
+ * also counts the longer round trips.
+ */
+#define HIST_BIN_MS	2
+#define HIST_BINS	32
+/*!
+ * Time without a character after which the robot is taken as lost, in ms.
+ */
+#define BENCH_TIMEOUT_MS	2000
+/*!
+ * Maximum number of round trips kept for the percentiles.
+ */
+#define RTT_MAX_NB	65536
+
+static int fd;
+static double bytes;		/*!< Bytes received since the start */
+static double images;		/*!< Images received since the start */
+static unsigned int hist[HIST_BINS];
+static double *rtts;		/*!< Round trips in ms */
+static unsigned int rtt_nb;
+static unsigned int cols, rows;	/*!< Geometry of the last PMT_CONFIG */
+static uint8_t seq_next;	/*!< Next PMT_VISUAL_SEQ expected */
+static unsigned int seq_drops;	/*!< PMT_VISUAL_SEQ out of sequence */
+static FILE *trace;		/*!< Where the messages are saved, or NULL */
+
+/*!
+ * Gives a monotonic time in s.
+ */
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*!
+ * Opens the serial line, raw at BENCH_BAUD.
+ *
+ * \return	0 if the line is open, -1 otherwise.
+ */
+static int open_line(const char *path)
+{
+	struct termios tio;
+
+	fd = open(path, O_RDWR | O_NOCTTY);
+	if (fd < 0)
+		return -1;
+	if (tcgetattr(fd, &tio) < 0)
+		return -1;
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, B115200);
+	cfsetospeed(&tio, B115200);
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	if (tcsetattr(fd, TCSANOW, &tio) < 0)
+		return -1;
+	tcflush(fd, TCIOFLUSH);
+	return 0;
+}
+
+/*!
+ * Reads exactly len bytes.
+ *
+ * \param	first	Where to store the time of the first byte, or NULL.
+ *
+ * \return	0 once the bytes are read, -1 on a timeout or an error.
+ */
+static int read_all(void *buf, size_t len, double *first)
+{
+	unsigned char *p = buf;
+	struct timeval tv;
+	fd_set set;
+	ssize_t n;
+
+	while (len > 0) {
+		FD_ZERO(&set);
+		FD_SET(fd, &set);
+		tv.tv_sec = BENCH_TIMEOUT_MS / 1000;
+		tv.tv_usec = (BENCH_TIMEOUT_MS % 1000) * 1000;
+		if (select(fd + 1, &set, NULL, NULL, &tv) <= 0)
+			return -1;
+		n = read(fd, p, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		if ((n > 0) && (first != NULL)) {
+			*first = now();
+			first = NULL;
+		}
+		p += n;
+		len -= n;
+		bytes += n;
+	}
+	return 0;
+}
+
+/*!
+ * Checks the type of a header, the robot only sends these.
+ */
+static int known_type(unsigned int type)
+{
+	return (type == PMT_CONFIG) || (type == PMT_VISUAL)
+		|| ((type >= PMT_VISUAL_DELTA) && (type <= PMT_PARAM)
+			&& (type != PMT_NAV_WEIGHTS) && (type != PMT_SEQ_ACK)
+			&& (type != PMT_SLOT));
+}
+
+/*!
+ * Reads the next header. The bytes before a known type are skipped, so the
+ * benchmark also starts in the middle of a message.
+ *
+ * \return	0 once a header is read, -1 on a timeout or an error.
+ */
+static int read_hdr(struct puck_msg_hdr *hdr)
+{
+	unsigned char *p = (unsigned char *)hdr;
+
+	if (read_all(p, sizeof(*hdr), NULL) < 0)
+		return -1;
+	while (!known_type(hdr->type)) {
+		memmove(p, p + 1, sizeof(*hdr) - 1);
+		if (read_all(p + sizeof(*hdr) - 1, 1, NULL) < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/*!
+ * Saves a message in the trace, if there is one.
+ */
+static void save(unsigned int type, const unsigned char *payload,
+		unsigned int len)
+{
+	struct puck_msg_hdr hdr;
+
+	if (trace == NULL)
+		return;
+	hdr.type = type;
+	hdr.len = len;
+	fwrite(&hdr, sizeof(hdr), 1, trace);
+	fwrite(payload, 1, len, trace);
+}
+
+static void add_rtt(double ms)
+{
+	unsigned int bin = ms / HIST_BIN_MS;
+
+	hist[(bin < HIST_BINS) ? bin : HIST_BINS - 1]++;
+	if (rtt_nb < RTT_MAX_NB)
+		rtts[rtt_nb++] = ms;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+	double x = *(const double *)a, y = *(const double *)b;
+
+	return (x > y) - (x < y);
+}
+
+/*!
+ * Gives a percentile of the sorted round trips.
+ */
+static double percentile(unsigned int pct)
+{
+	if (rtt_nb == 0)
+		return 0.0;
+	return rtts[(rtt_nb - 1) * pct / 100];
+}
+
+/*!
+ * Reads the payload of a PMT_VISUAL_SEQ and acknowledges the images
+ * received in sequence.
+ *
+ * \return	0 once the message is read, -1 on a timeout or an error.
+ */
+static int receive_seq(const struct puck_msg_hdr *hdr, unsigned char *payload)
+{
+	struct puck_msg_hdr ack_hdr;
+	struct puck_msg_seq_ack ack;
+
+	if (read_all(payload, hdr->len, NULL) < 0)
+		return -1;
+	if (((struct puck_msg_seq *)payload)->seq == seq_next) {
+		seq_next++;
+		images++;
+		save(((struct puck_msg_seq *)payload)->type,
+				payload + sizeof(struct puck_msg_seq),
+				hdr->len - sizeof(struct puck_msg_seq));
+	}
+	else
+		seq_drops++;
+	ack_hdr.type = PMT_SEQ_ACK;
+	ack_hdr.len = sizeof(ack);
+	ack.next = seq_next;
+	if ((write(fd, &ack_hdr, sizeof(ack_hdr)) != sizeof(ack_hdr))
+			|| (write(fd, &ack, sizeof(ack)) != sizeof(ack)))
+		return -1;
+	return 0;
+}
+
+/*!
+ * Reads a PMT_VISUAL_ID, header and payload come back to back, and
+ * acknowledges it. It only comes from a robot given a PMT_SLOT.
+ *
+ * \return	0 once the message is read, -1 on a timeout or an error.
+ */
+static int receive_id(const struct puck_msg_hdr *hdr, unsigned char *payload)
+{
+	struct puck_msg_hdr inner;
+	struct puck_msg_id id;
+	unsigned char ack = PMT_ACK;
+
+	if (read_all(&id, sizeof(id), NULL) < 0)
+		return -1;
+	inner.type = id.type;
+	inner.len = hdr->len - sizeof(id);
+	if (inner.type == PMT_VISUAL_SEQ)
+		return receive_seq(&inner, payload);
+	if (read_all(payload, inner.len, NULL) < 0)
+		return -1;
+	images++;
+	save(inner.type, payload, inner.len);
+	if (write(fd, &ack, 1) != 1)
+		return -1;
+	return 0;
+}
+
+/*!
+ * Receives one message: waits for its header, acknowledges it and reads its
+ * payload.
+ *
+ * \return	0 once the message is read, -1 on a timeout or an error.
+ */
+static int receive(unsigned char *payload)
+{
+	struct puck_msg_hdr hdr;
+	unsigned char ack = PMT_ACK;
+	double sent, first;
+
+	if (read_hdr(&hdr) < 0)
+		return -1;
+	if (hdr.type == PMT_VISUAL_SEQ)
+		return receive_seq(&hdr, payload);
+	if (hdr.type == PMT_VISUAL_ID)
+		return receive_id(&hdr, payload);
+	sent = now();
+	if (write(fd, &ack, 1) != 1)
+		return -1;
+	if (hdr.len == 0)
+		return 0;
+	if (read_all(payload, hdr.len, &first) < 0)
+		return -1;
+	add_rtt((first - sent) * 1000.0);
+	save(hdr.type, payload, hdr.len);
+
+	switch (hdr.type) {
+	case PMT_CONFIG:
+		cols = ((struct puck_msg_config *)payload)->cols;
+		rows = ((struct puck_msg_config *)payload)->rows;
+		seq_next = 0;
+		break;
+	case PMT_VISUAL:
+	case PMT_VISUAL_DELTA:
+	case PMT_VISUAL_ROWS:
+	case PMT_VISUAL_PROFILE:
+	case PMT_VISUAL_BLOB:
+		images++;
+		break;
+	}
+	return 0;
+}
+
+static void report(const char *label, double seconds)
+{
+	double busy = bytes * BENCH_CHAR_BITS / BENCH_BAUD;
+	double idle = (seconds > 0.0) ? 1.0 - busy / seconds : 0.0;
+	unsigned int i, j, top = 1;
+
+	qsort(rtts, rtt_nb, sizeof(rtts[0]), cmp_double);
+	for (i = 0; i < HIST_BINS; i++)
+		if (hist[i] > top)
+			top = hist[i];
+
+	fprintf(stderr, "%ux%u: %.0f images in %.1f s, %.2f images/s, "
+			"%.0f bytes/s, line idle %.1f %%\n", cols, rows,
+			images, seconds, images / seconds, bytes / seconds,
+			idle * 100.0);
+	if (seq_drops != 0)
+		fprintf(stderr, "%u images out of sequence\n", seq_drops);
+	fprintf(stderr, "round trips (ms), %u:\n", rtt_nb);
+	for (i = 0; i < HIST_BINS; i++) {
+		if (hist[i] == 0)
+			continue;
+		fprintf(stderr, "%3u%s %6u ", i * HIST_BIN_MS,
+				(i == HIST_BINS - 1) ? "+" : " ", hist[i]);
+		for (j = 0; j < hist[i] * 50 / top; j++)
+			fputc('#', stderr);
+		fputc('\n', stderr);
+	}
+
+	printf("%s,%u,%u,%.1f,%.0f,%.3f,%.0f,%.4f,%.2f,%.2f,%.2f,%.2f\n",
+			label, cols, rows, seconds, images, images / seconds,
+			bytes / seconds, idle, percentile(0), percentile(50),
+			percentile(95), percentile(100));
+}
+
+int main(int argc, char **argv)
+{
+	static unsigned char payload[65536];
+	double seconds = 30.0, start, end;
+
+	if ((argc < 2) || (argc > 5)) {
+		fprintf(stderr, "usage: %s <tty> [seconds] [label] [trace]\n",
+				argv[0]);
+		return 2;
+	}
+	if (argc > 2)
+		seconds = atof(argv[2]);
+	if (open_line(argv[1]) < 0) {
+		perror(argv[1]);
+		return 1;
+	}
+	rtts = malloc(RTT_MAX_NB * sizeof(rtts[0]));
+	if (rtts == NULL)
+		return 1;
+	if (argc > 4) {
+		trace = fopen(argv[4], "wb");
+		if (trace == NULL) {
+			perror(argv[4]);
+			return 1;
+		}
+	}
+
+	/* the first message starts the clock, its bytes are not counted */
+	if (receive(payload) < 0) {
+		fprintf(stderr, "%s: no message from the robot\n", argv[1]);
+		return 1;
+	}
+	bytes = 0;
+	images = 0;
+	rtt_nb = 0;
+	seq_drops = 0;
+	memset(hist, 0, sizeof(hist));
+	start = now();
+	end = start;
+	do {
+		if (receive(payload) < 0) {
+			fprintf(stderr, "%s: the robot stopped sending\n",
+					argv[1]);
+			break;
+		}
+		end = now();
+	} while (end - start < seconds);
+
+	report((argc > 3) ? argv[3] : "", end - start);
+	if (trace != NULL)
+		fclose(trace);
+	close(fd);
+	return 0;
+}
+
+/*!
+ * @}
+ */